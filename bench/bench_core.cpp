@@ -0,0 +1,337 @@
+/**
+ * \file bench_core.cpp
+ * \brief Google Benchmark microbenchmarks of the hot paths of the core (Grid, Piece,
+ * piece generation and replay playback), on the default board and on an oversized one.
+ * \author Alexandre Bleuler - Bonaventure Dohemeto
+ * \version 2.0
+ * \date 18/10/2026
+ */
+
+#include <benchmark/benchmark.h>
+
+#include "ai.h"
+#include "core_class.h"
+#include "game.h"
+#include "placement.h"
+#include "replay.h"
+#include "simd.h"
+#include "simulation.h"
+
+// Each benchmark runs on the default board (20 x 10) and on an oversized one (200 x 64).
+#define BOARD_SIZES ->Args({20, 10})->Args({200, 64})
+
+// Fills the cells of a row, leaving the columns of \b holes empty.
+void fill_row(Grid& grid, unsigned int row, std::uint64_t holes=0)
+{
+    Block block;
+    for(unsigned int column=0; column<grid.row_size(); ++column)
+    {
+        if(!(holes>>column & 1)) grid(row, column).fill(block);
+    }
+}
+
+// Builds a grid whose \b cleared bottom rows are full, under a stack of 8 rows with one hole each.
+Grid make_stacked_grid(unsigned int nrow, unsigned int ncol, unsigned int cleared)
+{
+    Grid grid{nrow, ncol};
+    unsigned int row=nrow;
+    for(unsigned int i=0; i<cleared; ++i) fill_row(grid, --row);
+    for(unsigned int i=0; i<8; ++i, --row) fill_row(grid, row-1, std::uint64_t{1}<<(i*3%ncol));
+    return grid;
+}
+
+////////////////////////
+////// Grid class //////
+////////////////////////
+
+static void BM_Grid_copy(benchmark::State& state)
+{
+    Grid model=make_stacked_grid(state.range(0), state.range(1), 0);
+    Grid grid=model;
+    for(auto _ : state)
+    {
+        grid=model;
+        benchmark::DoNotOptimize(grid);
+    }
+}
+BENCHMARK(BM_Grid_copy) BOARD_SIZES;
+
+static void BM_Grid_put_piece(benchmark::State& state)
+{
+    Grid grid{static_cast<unsigned int>(state.range(0)), static_cast<unsigned int>(state.range(1))};
+    unsigned int type=0;
+    for(auto _ : state)
+    {
+        // The cells of the piece are cleared again so that every iteration starts from an empty grid.
+        Piece piece=grid.put_piece(static_cast<PieceType>(type), 2);
+        for(const Block& block : piece.blocks()) grid(block.row(), block.column()).clear();
+        type=(type+1)%7;
+        benchmark::DoNotOptimize(piece);
+    }
+}
+BENCHMARK(BM_Grid_put_piece) BOARD_SIZES;
+
+static void BM_Grid_move_piece_translation(benchmark::State& state)
+{
+    Grid grid{static_cast<unsigned int>(state.range(0)), static_cast<unsigned int>(state.range(1))};
+    Piece piece=grid.put_piece(PieceType::T, 5);
+    for(auto _ : state)
+    {
+        benchmark::DoNotOptimize(grid.move_piece(piece, Move::left));
+        benchmark::DoNotOptimize(grid.move_piece(piece, Move::right));
+    }
+    state.SetItemsProcessed(2*state.iterations());
+}
+BENCHMARK(BM_Grid_move_piece_translation) BOARD_SIZES;
+
+static void BM_Grid_move_piece_rotation(benchmark::State& state)
+{
+    Grid grid{static_cast<unsigned int>(state.range(0)), static_cast<unsigned int>(state.range(1))};
+    Piece piece=grid.put_piece(PieceType::J, 5);
+    for(auto _ : state)
+    {
+        benchmark::DoNotOptimize(grid.move_piece(piece, Move::clock_rotation));
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_Grid_move_piece_rotation) BOARD_SIZES;
+
+static void BM_Grid_move_piece_blocked(benchmark::State& state)
+{
+    // The piece lies on the stack : every move down is refused.
+    Grid grid=make_stacked_grid(state.range(0), state.range(1), 0);
+    Piece piece=grid.put_piece(PieceType::O, state.range(0)-10);
+    for(auto _ : state)
+    {
+        benchmark::DoNotOptimize(grid.move_piece(piece, Move::down));
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_Grid_move_piece_blocked) BOARD_SIZES;
+
+static void BM_Grid_drop_distance(benchmark::State& state)
+{
+    Grid grid=make_stacked_grid(state.range(0), state.range(1), 0);
+    Piece piece=grid.put_piece(PieceType::L);
+    for(auto _ : state)
+    {
+        benchmark::DoNotOptimize(grid.drop_distance(piece));
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_Grid_drop_distance) BOARD_SIZES;
+
+// The same drop with the kernels of each level (0 scalar, 1 SSE4.1, 2 AVX2).
+static void BM_Grid_drop_distance_level(benchmark::State& state)
+{
+    if(!simd::set_level(static_cast<simd::Level>(state.range(2))))
+    {
+        state.SkipWithError("level not supported by the processor");
+        return;
+    }
+    Grid grid=make_stacked_grid(state.range(0), state.range(1), 0);
+    Piece piece=grid.put_piece(PieceType::L);
+    for(auto _ : state)
+    {
+        benchmark::DoNotOptimize(grid.drop_distance(piece));
+    }
+    state.SetItemsProcessed(state.iterations());
+    simd::set_level(simd::detected_level());
+}
+BENCHMARK(BM_Grid_drop_distance_level)->ArgsProduct({{200}, {64}, {0, 1, 2}});
+
+// Copies a stacked grid and suppresses its full rows. BM_Grid_copy gives the cost of the copy.
+static void BM_Grid_update(benchmark::State& state)
+{
+    Grid model=make_stacked_grid(state.range(0), state.range(1), state.range(2));
+    Grid grid=model;
+    for(auto _ : state)
+    {
+        grid=model;
+        benchmark::DoNotOptimize(grid.update());
+    }
+    state.SetLabel(std::to_string(state.range(2))+" line(s) cleared");
+}
+BENCHMARK(BM_Grid_update)->ArgsProduct({{20}, {10}, {0, 1, 2, 3, 4}})->ArgsProduct({{200}, {64}, {0, 1, 2, 3, 4}});
+
+static void BM_Grid_get_full_rows(benchmark::State& state)
+{
+    Grid grid=make_stacked_grid(state.range(0), state.range(1), 4);
+    for(auto _ : state)
+    {
+        benchmark::DoNotOptimize(grid.get_full_rows().size());
+    }
+}
+BENCHMARK(BM_Grid_get_full_rows) BOARD_SIZES;
+
+static void BM_Grid_heights_and_holes(benchmark::State& state)
+{
+    Grid grid=make_stacked_grid(state.range(0), state.range(1), 0);
+    for(auto _ : state)
+    {
+        unsigned int bumpiness=0;
+        const std::vector<unsigned int>& heights=grid.column_heights();
+        for(std::size_t column=1; column<heights.size(); ++column)
+        {
+            bumpiness+= heights[column]>heights[column-1] ? heights[column]-heights[column-1] : heights[column-1]-heights[column];
+        }
+        benchmark::DoNotOptimize(bumpiness);
+        benchmark::DoNotOptimize(grid.holes());
+    }
+}
+BENCHMARK(BM_Grid_heights_and_holes) BOARD_SIZES;
+
+static void BM_get_grid(benchmark::State& state)
+{
+    Grid grid=make_stacked_grid(state.range(0), state.range(1), 4);
+    for(auto _ : state)
+    {
+        benchmark::DoNotOptimize(get_grid(grid));
+    }
+    state.SetBytesProcessed(state.iterations()*state.range(0)*(state.range(1)+1));
+}
+BENCHMARK(BM_get_grid) BOARD_SIZES;
+
+/////////////////////////
+////// Piece class //////
+/////////////////////////
+
+static void BM_Piece_rotation(benchmark::State& state)
+{
+    Piece piece{PieceType::L, 5, 5};
+    for(auto _ : state)
+    {
+        piece.move(Move::clock_rotation);
+        benchmark::DoNotOptimize(piece);
+        piece.move(Move::anticlock_rotation);
+        benchmark::DoNotOptimize(piece);
+    }
+    state.SetItemsProcessed(2*state.iterations());
+}
+BENCHMARK(BM_Piece_rotation);
+
+static void BM_Piece_blocks(benchmark::State& state)
+{
+    Piece piece{PieceType::S, 5, 5, 1};
+    for(auto _ : state)
+    {
+        benchmark::DoNotOptimize(piece.blocks());
+    }
+}
+BENCHMARK(BM_Piece_blocks);
+
+//////////////////////////////////
+////// PieceGenerator class //////
+//////////////////////////////////
+
+static void BM_PieceGenerator_next(benchmark::State& state)
+{
+    PieceGenerator generator{1, static_cast<GeneratorPolicy>(state.range(0))};
+    for(auto _ : state)
+    {
+        benchmark::DoNotOptimize(generator.next());
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_PieceGenerator_next)->Arg(0)->Arg(1)->Arg(2);
+
+////////////////////////////
+////// Placement search ////
+////////////////////////////
+
+static void BM_PlacementFinder_find(benchmark::State& state)
+{
+    Grid grid=make_stacked_grid(state.range(0), state.range(1), 0);
+    PlacementFinder finder;
+    unsigned int type=0;
+    std::size_t placements=0;
+    for(auto _ : state)
+    {
+        placements+=finder.find(grid, static_cast<PieceType>(type)).size();
+        type=(type+1)%7;
+    }
+    state.SetItemsProcessed(state.iterations());
+    state.counters["placements"]=benchmark::Counter(placements, benchmark::Counter::kAvgIterations);
+}
+BENCHMARK(BM_PlacementFinder_find) BOARD_SIZES;
+
+static void BM_AiPolicy_plan(benchmark::State& state)
+{
+    Grid grid=make_stacked_grid(state.range(0), state.range(1), 0);
+    std::uint64_t grids=0;
+    unsigned int type=0;
+    for(auto _ : state)
+    {
+        // A new policy for each plan, so that its transposition table never knows the grids.
+        state.PauseTiming();
+        AiPolicy policy{AiWeights{}, std::chrono::microseconds{0}, static_cast<unsigned int>(state.range(2))};
+        state.ResumeTiming();
+        policy.plan(grid, Piece{static_cast<PieceType>(type), 0, grid.row_size()/2}, static_cast<PieceType>((type+3)%7));
+        grids+=policy.evaluated_grids();
+        type=(type+1)%7;
+    }
+    state.counters["grids/s"]=benchmark::Counter(grids, benchmark::Counter::kIsRate);
+}
+// The last argument is the number of threads of the search, 0 meaning one per core.
+BENCHMARK(BM_AiPolicy_plan)->Args({20, 10, 1})->Args({20, 10, 4})->Args({20, 10, 0})->UseRealTime();
+
+static void BM_AiPolicy_replan(benchmark::State& state)
+{
+    // The same piece planned again, as when the gravity moves it before its placement
+    // is reached : the two-ply scores come from the transposition table.
+    Grid grid=make_stacked_grid(state.range(0), state.range(1), 0);
+    AiPolicy policy;
+    Piece piece{PieceType::T, 0, grid.row_size()/2};
+    policy.plan(grid, piece, PieceType::S);
+    for(auto _ : state)
+    {
+        policy.plan(grid, piece, PieceType::S);
+        benchmark::DoNotOptimize(policy.target());
+    }
+}
+BENCHMARK(BM_AiPolicy_replan)->Args({20, 10});
+
+////////////////////////////////
+////// Games and replays ///////
+////////////////////////////////
+
+static void BM_play_game(benchmark::State& state)
+{
+    SimulationConfig config;
+    config.rows=state.range(0);
+    config.columns=state.range(1);
+    RandomPolicy policy;
+    std::uint64_t seed=0;
+    std::uint64_t ticks=0;
+    for(auto _ : state)
+    {
+        GameResult result=play_game(config, seed++, policy);
+        ticks+=result.ticks;
+    }
+    state.counters["ticks/s"]=benchmark::Counter(ticks, benchmark::Counter::kIsRate);
+}
+BENCHMARK(BM_play_game) BOARD_SIZES;
+
+static void BM_play_replay(benchmark::State& state)
+{
+    Game game{static_cast<unsigned int>(state.range(0)), static_cast<unsigned int>(state.range(1)), 3};
+    game.set_recording(true);
+    RandomPolicy policy;
+    policy.reset(3);
+    while(!game.is_over())
+    {
+        Move move=policy.choose(game);
+        if(move!=Move::none) game.input(move);
+        game.tick();
+        game.clear_events();
+    }
+    Replay replay=make_replay(game);
+    for(auto _ : state)
+    {
+        benchmark::DoNotOptimize(play_replay(replay));
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_play_replay) BOARD_SIZES;
+
+BENCHMARK_MAIN();
@@ -0,0 +1,205 @@
+/**
+ * \file ai.h
+ * \brief
+ * This file contains the declarations of the automatic player : the weights of its
+ * evaluation of a grid and the AiPolicy class, which chooses where to lock each piece
+ * by looking at the current and the next piece.
+ * \author Alexandre Bleuler - Bonaventure Dohemeto
+ * \version 2.0
+ * \date 18/10/2026
+ */
+
+#ifndef CORE_AI
+#define CORE_AI
+
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include "parallel.h"
+#include "placement.h"
+#include "simulation.h"
+#include "transposition.h"
+
+/**
+ * \struct AiWeights
+ * \brief The weights of the features of a grid in its evaluation by the automatic player.
+ * The default values are the ones of a classic hand-tuned Tetris player.
+ */
+
+struct AiWeights
+{
+    double height=-0.510066; /**< The weight of the sum of the heights of the columns. */
+    double lines=0.760666; /**< The weight of the number of suppressed rows. */
+    double holes=-0.35663; /**< The weight of the number of holes. */
+    double bumpiness=-0.184483; /**< The weight of the sum of the height differences between neighbouring columns. */
+};
+
+/**
+ * \brief Evaluates a grid whose full rows have been suppressed.
+ * \param grid The grid to evaluate.
+ * \param lines The number of rows suppressed to reach the grid.
+ * \param weights The weights of the features of the grid.
+ * \return The score of the grid, the higher the better.
+*/
+
+double evaluate_grid(const Grid& grid, unsigned int lines, const AiWeights& weights);
+
+/**
+ * \class AiPolicy
+ * \brief An automatic player. When a new piece appears, every placement of the current
+ * piece is evaluated together with the best placement of the next piece (two-ply
+ * lookahead). The placements of the current piece are deepened from the most promising
+ * one until the time budget is spent, the others keeping their one-ply score. The
+ * chosen placement is then reached move by move, the last moves down being replaced
+ * by a hard drop. It can play simulated games as well as drive the game of the UI.
+ *
+ * The placements of the current piece can be shared between the workers of a thread
+ * pool, each of them locking the pieces in its own scratch grids. A placement is
+ * skipped when an upper bound of its two-ply score is below the best score found so
+ * far, which the workers share. The chosen placement doesn't depend on the number
+ * of threads when the time is not limited.
+ *
+ * The best score of the next piece in the grid reached by each placement of the current
+ * piece is kept in a transposition table, so that a grid met again (when the placement
+ * is chosen again after a fall of the piece, or through another order of moves) isn't
+ * searched twice.
+*/
+
+class AiPolicy : public MovePolicy
+{
+    public :
+
+        /**
+         * \brief Constructs the automatic player.
+         * \param weights The weights of its evaluation of the grids.
+         * \param budget The time allowed to choose a placement, 0 meaning no limit.
+         * \param threads The number of threads of the search, 0 meaning one per core.
+        */
+
+        AiPolicy(const AiWeights& weights=AiWeights{}, std::chrono::microseconds budget=std::chrono::microseconds{0},
+                 unsigned int threads=1);
+
+        void reset(std::uint64_t seed) override;
+        Move choose(const Game& game) override;
+
+        /**
+         * \brief Chooses the placement of the current piece of a game.
+         * \param game The game being played.
+         * \return A boolean asserting if a placement was found.
+        */
+
+        bool plan(const Game& game);
+
+        /**
+         * \brief Chooses the placement of a piece in a grid, knowing the next piece.
+         * \param grid The grid, which mustn't contain the piece.
+         * \param current The piece to place, in its current state.
+         * \param next The type of the next piece.
+         * \return A boolean asserting if a placement was found.
+        */
+
+        bool plan(const Grid& grid, const Piece& current, PieceType next);
+
+        /**
+         * \brief A getter for the placement chosen by the last call to plan().
+         * \param
+         * \return The chosen placement.
+        */
+
+        const Placement& target() const {return _target;}
+
+        /**
+         * \brief A getter for the number of grids evaluated by the last call to plan().
+         * \param
+         * \return The number of evaluated grids.
+        */
+
+        std::uint64_t evaluated_grids() const {return _evaluated_grids;}
+
+        /**
+         * \brief A getter for the number of placements of the current piece skipped by the
+         * last call to plan() because they could not beat the best one.
+         * \param
+         * \return The number of skipped placements.
+        */
+
+        std::uint64_t pruned_placements() const {return _pruned_placements;}
+
+        /**
+         * \brief A getter for the number of placements of the current piece whose two-ply
+         * score was found in the transposition table by the last call to plan().
+         * \param
+         * \return The number of placements found in the table.
+        */
+
+        std::uint64_t cache_hits() const {return _cache_hits;}
+
+        /**
+         * \brief A getter for the number of threads of the search.
+         * \param
+         * \return The number of threads.
+        */
+
+        unsigned int threads() const {return static_cast<unsigned int>(_workers.size());}
+
+    private :
+
+        /**
+         * \struct Worker
+         * \brief The scratch state of a thread of the search.
+        */
+
+        struct Worker
+        {
+            PlacementFinder finder; /**< The finder of the placements of the next piece. */
+            Grid first; /**< The grid once the current piece is locked. */
+            Grid second; /**< The grid once the next piece is locked. */
+        };
+
+        AiWeights _weights; /**< The weights of the evaluation of the grids. */
+        std::chrono::microseconds _budget; /**< The time allowed to choose a placement, 0 meaning no limit. */
+        std::unique_ptr<ThreadPool> _pool; /**< The threads of the search, none if it runs on the calling thread. */
+        std::vector<Worker> _workers; /**< The scratch state of each thread of the search. */
+        TranspositionTable _table; /**< The best score of the next piece in the grids already searched, without the rows suppressed before. */
+        PlacementFinder _first_finder; /**< The finder of the placements of the current piece. */
+        Grid _root; /**< The grid without the current piece. */
+        Grid _first; /**< The grid once the current piece is locked, for the one-ply scores. */
+        std::vector<double> _first_scores; /**< The one-ply score of each placement of the current piece. */
+        std::vector<double> _second_scores; /**< The two-ply score of each placement of the current piece. */
+        std::vector<char> _is_deepened; /**< A flag for each placement of the current piece given a two-ply score. */
+        std::vector<std::size_t> _order; /**< The placements of the current piece, from the best one-ply score. */
+        std::vector<std::size_t> _schedule; /**< The rank in _order processed at each index of the parallel loop. */
+        std::vector<Move> _moves; /**< The moves leading the current piece to the chosen placement. */
+        std::size_t _next_move=0; /**< The index of the next move to perform. */
+        Placement _target{}; /**< The chosen placement. */
+        Piece _expected; /**< The state the current piece should be in before the next move. */
+        std::uint64_t _planned_piece=~std::uint64_t{0}; /**< The piece_count() of the game when the placement was chosen. */
+        std::uint64_t _evaluated_grids=0; /**< The number of grids evaluated by the last call to plan(). */
+        std::uint64_t _pruned_placements=0; /**< The number of placements skipped by the last call to plan(). */
+        std::uint64_t _cache_hits=0; /**< The number of placements found in the transposition table by the last call to plan(). */
+        bool _can_prune; /**< A boolean indicating if the signs of the weights allow an upper bound of the scores. */
+
+        /**
+         * \brief Locks a piece in a scratch grid and suppresses its full rows.
+         * \param grid The scratch grid, containing the grid before the piece.
+         * \param piece The piece to lock.
+         * \param lines The number of suppressed rows.
+         * \return A boolean asserting if the game would be over.
+        */
+
+        bool lock(Grid& grid, const Piece& piece, unsigned int& lines);
+
+        /**
+         * \brief Bounds the two-ply score of a placement of the current piece from above,
+         * whatever the placement of the next piece.
+         * \param grid The grid once the current piece is locked.
+         * \param lines The number of rows suppressed by the current piece.
+         * \return The upper bound.
+        */
+
+        double upper_bound(const Grid& grid, unsigned int lines) const;
+};
+
+#endif
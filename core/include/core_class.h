@@ -12,7 +12,11 @@
 #define CORE_CLASS
 
 
+#include <array>
 #include <vector>
+#include <string>
+#include <cstdint>
+#include <type_traits>
 
 /**
  * \enum Move
@@ -27,6 +31,7 @@ enum class Move{
     right, /**< Rightward movement */
     clock_rotation, /**< Clockwise rotation */
     anticlock_rotation, /**< Anticlockwise rotation */
+    hard_drop, /**< Drop of a piece straight to its landing row (handled by Grid and Game only) */
     none /**< No movement */
 }; 
 
@@ -38,12 +43,26 @@ enum class Move{
 
 Move reverse_move(Move move);
 
+/**
+ * \brief The splitmix64 finalizer, spreading every bit of its input over its output. It
+ * derives the seeds, generator states and hash keys of the core from simple counters.
+ * \param x The value to mix.
+ * \return The mixed value.
+*/
+
+inline std::uint64_t mix64(std::uint64_t x)
+{
+    x= (x ^ (x>>30))*0xBF58476D1CE4E5B9ull;
+    x= (x ^ (x>>27))*0x94D049BB133111EBull;
+    return x ^ (x>>31);
+}
+
 /**
  * \enum PieceType
  * \brief An enum class to manipulate type of Tetris' blocks (see the readme.md to check the corresponding piece).
  */
 
-enum class PieceType { 
+enum class PieceType : unsigned char { 
     I=0, /**< I piece */
     O=1, /**< O piece */
     T=2, /**< T piece */
@@ -55,10 +74,11 @@ enum class PieceType {
 /**
  * \enum Move
  * \brief An enum class to set the color of a given PieceType.
- * They are mapped through indexes of the enum. 
+ * They are mapped through indexes of the enum. It is stored on a single
+ * byte to keep the color buffer of a Grid compact.
  */
 
-enum class Color{
+enum class Color : unsigned char {
     blue=0, /**< Color associated with element number 0 of PieceType (I currently). */
     yellow=1, /**< Color associated with element number 1 of PieceType (O currently). */
     purple=2, /**< Color associated with element number 2 of PieceType (T currently. */
@@ -154,6 +174,129 @@ class Block
         Color _color; /**< The color of the block. */
 };
 
+/**
+ * @struct BlockOffset
+ * @brief Position of a block relative to the pivot of its piece.
+ */
+struct BlockOffset
+{
+    int row;    /*!< Row offset from the pivot (positive downward) */
+    int column; /*!< Column offset from the pivot (positive rightward) */
+};
+
+/**
+ * @brief Shapes of the seven PieceTypes in their four rotation states.
+ *
+ * piece_shapes[type][rotation][i] is the offset of block i relative to the pivot,
+ * the first block being the pivot itself. The state k is obtained from the state 0
+ * with k clockwise rotations around the pivot. The O piece doesn't rotate, so its
+ * four states are identical.
+ */
+inline constexpr BlockOffset piece_shapes[7][4][4] = {
+    { // PieceType::I
+        {{ 0, 0}, { 0,-1}, { 0,-2}, { 0, 1}},
+        {{ 0, 0}, {-1, 0}, {-2, 0}, { 1, 0}},
+        {{ 0, 0}, { 0, 1}, { 0, 2}, { 0,-1}},
+        {{ 0, 0}, { 1, 0}, { 2, 0}, {-1, 0}}
+    },
+    { // PieceType::O
+        {{ 0, 0}, { 0,-1}, { 1, 0}, { 1,-1}},
+        {{ 0, 0}, { 0,-1}, { 1, 0}, { 1,-1}},
+        {{ 0, 0}, { 0,-1}, { 1, 0}, { 1,-1}},
+        {{ 0, 0}, { 0,-1}, { 1, 0}, { 1,-1}}
+    },
+    { // PieceType::T
+        {{ 0, 0}, { 0,-1}, { 0, 1}, { 1, 0}},
+        {{ 0, 0}, {-1, 0}, { 1, 0}, { 0,-1}},
+        {{ 0, 0}, { 0, 1}, { 0,-1}, {-1, 0}},
+        {{ 0, 0}, { 1, 0}, {-1, 0}, { 0, 1}}
+    },
+    { // PieceType::L
+        {{ 0, 0}, { 0,-1}, { 0, 1}, { 1,-1}},
+        {{ 0, 0}, {-1, 0}, { 1, 0}, {-1,-1}},
+        {{ 0, 0}, { 0, 1}, { 0,-1}, {-1, 1}},
+        {{ 0, 0}, { 1, 0}, {-1, 0}, { 1, 1}}
+    },
+    { // PieceType::J
+        {{ 0, 0}, { 0,-1}, { 0, 1}, { 1, 1}},
+        {{ 0, 0}, {-1, 0}, { 1, 0}, { 1,-1}},
+        {{ 0, 0}, { 0, 1}, { 0,-1}, {-1,-1}},
+        {{ 0, 0}, { 1, 0}, {-1, 0}, {-1, 1}}
+    },
+    { // PieceType::S
+        {{ 0, 0}, { 0, 1}, { 1, 0}, { 1,-1}},
+        {{ 0, 0}, { 1, 0}, { 0,-1}, {-1,-1}},
+        {{ 0, 0}, { 0,-1}, {-1, 0}, {-1, 1}},
+        {{ 0, 0}, {-1, 0}, { 0, 1}, { 1, 1}}
+    },
+    { // PieceType::Z
+        {{ 0, 0}, { 0,-1}, { 1, 0}, { 1, 1}},
+        {{ 0, 0}, {-1, 0}, { 0,-1}, { 1,-1}},
+        {{ 0, 0}, { 0, 1}, {-1, 0}, {-1,-1}},
+        {{ 0, 0}, { 1, 0}, { 0, 1}, {-1, 1}}
+    }
+};
+
+/**
+ * @struct ShapeMask
+ * @brief The cells of a piece in one rotation state packed in occupancy words, so that
+ * it can be tested against the rows of a grid (see Grid::row_mask) a row at a time.
+ */
+struct ShapeMask
+{
+    std::uint64_t rows[4]; /*!< The cells of each row from the top of the shape, bit c for its c-th column from the left (0 past its height) */
+    int top;               /*!< Row offset of the top of the shape from the pivot */
+    int left;              /*!< Column offset of the left of the shape from the pivot */
+    unsigned int height;   /*!< The number of rows of the shape */
+    unsigned int width;    /*!< The number of columns of the shape */
+};
+
+/**
+ * @brief Packs the blocks of a piece shape in a ShapeMask.
+ * @param offsets The offsets of the four blocks from the pivot.
+ * @return The mask of the shape.
+ */
+constexpr ShapeMask make_shape_mask(const BlockOffset (&offsets)[4])
+{
+    ShapeMask mask{{0, 0, 0, 0}, 0, 0, 0, 0};
+    int bottom=0;
+    int right=0;
+    for(const BlockOffset& offset : offsets)
+    {
+        mask.top= offset.row<mask.top ? offset.row : mask.top;
+        mask.left= offset.column<mask.left ? offset.column : mask.left;
+        bottom= offset.row>bottom ? offset.row : bottom;
+        right= offset.column>right ? offset.column : right;
+    }
+    mask.height=static_cast<unsigned int>(bottom-mask.top+1);
+    mask.width=static_cast<unsigned int>(right-mask.left+1);
+    for(const BlockOffset& offset : offsets)
+    {
+        mask.rows[offset.row-mask.top]|= std::uint64_t{1}<<(offset.column-mask.left);
+    }
+    return mask;
+}
+
+/**
+ * @brief Packs the shapes of the seven PieceTypes in their four rotation states.
+ * @return The masks, indexed like piece_shapes.
+ */
+constexpr std::array<std::array<ShapeMask, 4>, 7> make_shape_masks()
+{
+    std::array<std::array<ShapeMask, 4>, 7> masks{};
+    for(unsigned int type=0; type<7; ++type)
+    {
+        for(unsigned int rotation=0; rotation<4; ++rotation) masks[type][rotation]=make_shape_mask(piece_shapes[type][rotation]);
+    }
+    return masks;
+}
+
+/**
+ * @brief Masks of the seven PieceTypes in their four rotation states :
+ * shape_masks[type][rotation] holds the blocks of piece_shapes[type][rotation].
+ */
+inline constexpr std::array<std::array<ShapeMask, 4>, 7> shape_masks=make_shape_masks();
+
 /**
  * @class Piece
  * 
@@ -164,6 +307,10 @@ class Block
  * @class Piece
  * @brief Represents a Tetris piece with blocks, type, pivot, and rotation logic.
  *
+ * A piece is only a type, a rotation state and the coordinates of its pivot : the
+ * positions of its blocks are read from piece_shapes, so rotations and copies are
+ * almost free.
+ *
  * - Initialize blocks for a given piece type at specific pivot coordinates.
  * - Provide access to block positions, pivot, and color.
  * - Support rotation around the pivot (clockwise and counterclockwise).
@@ -175,15 +322,16 @@ public:
     /**
      * @brief Constructs a Piece of a given type at the specified pivot coordinates.
      * 
-     * The constructor initializes the blocks for the specified piece type and sets
-     * the pivot index. The piece is positioned on the grid according to the provided
-     * pivot coordinates.
+     * The piece is positioned on the grid according to the provided pivot coordinates,
+     * in the given rotation state.
      * 
      * @param type The type of the piece (I, O, T, J, L, S, Z).
      * @param pivotRow Row index of the pivot block (default 0).
      * @param pivotCol Column index of the pivot block (default 0).
+     * @param rotation Rotation state of the piece, from 0 to 3 (default 0).
      */
-    Piece(PieceType type = PieceType::I, unsigned int pivotRow = 0, unsigned int pivotCol = 0);
+    Piece(PieceType type = PieceType::I, unsigned int pivotRow = 0, unsigned int pivotCol = 0, unsigned int rotation = 0)
+    : _type(type), _rotation(static_cast<unsigned char>(rotation & 3u)), _pivot_row(pivotRow), _pivot_col(pivotCol) {}
 
     /**
      * @brief Returns the type of the piece.
@@ -191,6 +339,15 @@ public:
      */
     PieceType type() const { return _type; }
 
+    /**
+     * @brief Returns the rotation state of the piece.
+     * 
+     * The state k corresponds to k clockwise rotations from the spawn orientation.
+     * 
+     * @return Rotation state, from 0 to 3.
+     */
+    unsigned int rotation() const { return _rotation; }
+
     /**
      * @brief Returns the row index of the pivot block.
      * 
@@ -198,14 +355,14 @@ public:
      * 
      * @return Row index of the pivot block.
      */
-    unsigned int pivot_row() const { return _blocks[_pivot_idx].row(); }
+    unsigned int pivot_row() const { return _pivot_row; }
 
     /**
      * @brief Returns the column index of the pivot block.
      * 
      * @return Column index of the pivot block.
      */
-    unsigned int pivot_col() const { return _blocks[_pivot_idx].column(); }
+    unsigned int pivot_col() const { return _pivot_col; }
 
     /**
      * @brief Access a block at the specified index.
@@ -215,33 +372,36 @@ public:
      * @param i Index of the block (0 to size()-1).
      * @return Copy of the Block at the given index.
      */
-    Block operator[](unsigned int i) const { return _blocks[i]; }
+    Block operator[](unsigned int i) const
+    {
+        const BlockOffset& offset = piece_shapes[static_cast<int>(_type)][_rotation][i];
+        return Block{_pivot_row + static_cast<unsigned int>(offset.row),
+                     _pivot_col + static_cast<unsigned int>(offset.column), color()};
+    }
 
     /**
-     * @brief Access a block at the specified index.
+     * @brief Returns the four blocks of the piece.
      * 
-     * Provides read/write access to a specific block in the piece.
+     * The blocks are stored inline, so iterating over them never allocates.
      * 
-     * @param i Index of the block (0 to size()-1).
-     * @return Reference to the Block at the given index.
+     * @return Array of the blocks, the pivot being the first one.
      */
-    Block& operator[](unsigned int i) { return _blocks[i]; }
+    std::array<Block, 4> blocks() const { return {(*this)[0], (*this)[1], (*this)[2], (*this)[3]}; }
 
     /**
      * @brief Returns the color of the piece.
      * 
-     * The color is taken from the first block of the piece. All blocks of a piece
-     * typically share the same color.
+     * All blocks of a piece share the color mapped to its type.
      * 
      * @return Color of the piece.
      */
-    Color color() const { return (*this)[0].color(); }
+    Color color() const { return static_cast<Color>(static_cast<int>(_type)); }
 
     /**
      * @brief Returns the number of blocks composing the piece.
-     * @return Number of blocks (usually 4 for standard Tetris pieces).
+     * @return Number of blocks (4 for standard Tetris pieces).
      */
-    unsigned int size() const { return static_cast<unsigned int>(_blocks.size()); }
+    unsigned int size() const { return 4; }
 
     /**
      * @brief Moves or rotates the piece.
@@ -259,35 +419,14 @@ public:
 
 private:
     PieceType _type;                  /*!< Type of the piece (I, O, T, J, L, S, Z) */
-    std::vector<Block> _blocks;       /*!< Blocks composing the piece */
-    unsigned int _pivot_idx;          /*!< Index of the pivot block in _blocks */
-
-    /**
-     * @brief Initializes the blocks for the piece based on its type.
-     * 
-     * Sets the default shape of the piece and determines which block is the pivot.
-     * Moves the piece to the provided pivot coordinates on the grid.
-     * 
-     */
-    void initializeBlocks();
-
-    /**
-     * @brief Rotates the piece 90° clockwise around its pivot.
-     * 
-     * Uses the pivot block as the center and rotates all other blocks around it
-     * according to standard Tetris rotation rules.
-     */
-    void clock_rotate();
-
-    /**
-     * @brief Rotates the piece 90° counterclockwise around its pivot.
-     * 
-     * Uses the pivot block as the center and rotates all other blocks around it
-     * in the opposite direction of clock_rotate().
-     */
-    void anticlock_rotate();
+    unsigned char _rotation;          /*!< Rotation state, index in piece_shapes */
+    unsigned int _pivot_row;          /*!< Row index of the pivot block */
+    unsigned int _pivot_col;          /*!< Column index of the pivot block */
 };
 
+static_assert(std::is_trivially_copyable<Block>::value, "Block must stay trivially copyable.");
+static_assert(std::is_trivially_copyable<Piece>::value, "Piece must stay trivially copyable.");
+
 /**
  * \class Cell
  * \brief A class which creates the entities representing the cells of the Tetris' grid. 
@@ -314,7 +453,7 @@ class Cell
          * \return
         */
 
-        void fill(Block& block){_is_full=true;_color=block.color();}
+        void fill(const Block& block){_is_full=true;_color=block.color();}
 
         /**
          * \brief Clears the cell by making it empty. 
@@ -351,15 +490,95 @@ class Cell
  * through methods using the creation and the movements of Piece entities. It is 
  * designed to be used as interface between the core of the game and it's UI made
  * with SFML. The index (0,0) represents grid's top-left corner.
+ * 
+ * The cells are not stored as Cell entities : the occupancy of each row is packed
+ * in a single machine word (bit \b c set when the cell of column \b c is full) and
+ * the colors are kept in a separate flat array. Collision tests and full rows
+ * detection are therefore a few bitwise operations. The grid can't have more than
+ * max_columns columns. The rows of the color array are reached through a table of
+ * row indexes, so that suppressing full rows only rotates indexes instead of
+ * copying the colors of every row above them.
 */
 
 class Grid
 {   
     public :
 
+        /**
+         * \class CellProxy
+         * \brief A lightweight handle on a cell of a grid, returned by the non-const
+         * operator() of Grid. It offers the same methods as Cell but forwards the
+         * modifications to the grid so that its packed occupancy stays consistent.
+        */
+
+        class CellProxy
+        {
+            public :
+
+                /**
+                 * \brief Constructs the handle on the cell ( \b row , \b column ) of \b grid .
+                 * \param grid The grid which contains the cell.
+                 * \param row The row's index of the cell.
+                 * \param column The column's index of the cell.
+                 * \return
+                */
+
+                CellProxy(Grid& grid, unsigned int row, unsigned int column) : _grid{grid}, _row{row}, _column{column} {}
+
+                /**
+                 * \brief Fills the cell with the color of \b block .
+                 * \param block The instance of type Block that correspond to the cell.
+                 * \return
+                */
+
+                void fill(const Block& block){_grid.fill_cell(_row, _column, block.color());}
+
+                /**
+                 * \brief Clears the cell by making it empty. 
+                 * \param
+                 * \return
+                */
+
+                void clear(){_grid.clear_cell(_row, _column);}
+
+                /**
+                 * \brief Checks if the cell if full.
+                 * \param
+                 * \return A boolean asserting if the cell is full. 
+                */
+
+                bool is_full() const {return cell().is_full();}
+
+                /**
+                 * \brief A getter for the color of the cell.
+                 * \param
+                 * \return The color of the cell.
+                */
+
+                Color color() const {return cell().color();}
+
+                /**
+                 * \brief Converts the handle into a copy of the cell it refers to.
+                 * \param
+                 * \return The cell corresponding to the handle.
+                */
+
+                operator Cell() const {return cell();}
+
+            private :
+                Grid& _grid; /**< The grid which contains the cell. */
+                unsigned int _row; /**< The row's index of the cell. */
+                unsigned int _column; /**< The column's index of the cell. */
+
+                Cell cell() const {return static_cast<const Grid&>(_grid)(_row, _column);}
+        };
+
+        static constexpr unsigned int max_columns = 64; /**< The maximum number of columns, i.e. the number of bits of a row's word. */
+
         /**
          * \brief Constructs the grid from the number of rows and colums it 
          * should have. The size if of 18 rows and 10 columns by default.The default score is 0.
+         * Throws std::invalid_argument if \b ncol is greater than max_columns.
          * \param nrow The number of rows of the grid.
          * \param ncol The number of columns of the grid.
         */
@@ -375,24 +594,23 @@ class Grid
         unsigned int score() const {return _score;}
         
         /**
-         * \brief Gets the Cell entity corresponding to a given position of the 
-         * attribute \b matrix . 
+         * \brief Gets the Cell entity corresponding to a given position of the grid. 
          * \param row The row's index of the cell.
          * \param col The column's index of the cell
          * \return The cell corresponding to the position ( \b row , \b col ).
         */
 
-        Cell operator()(unsigned int row, unsigned int column) const {return matrix[row][column];} 
+        Cell operator()(unsigned int row, unsigned int column) const 
+        {return Cell{((_rows[row]>>column) & 1u)!=0, _colors[_row_index[row]*_ncol+column]};} 
 
         /**
-         * \brief Sets the Cell entity corresponding to a given position of the 
-         * attribute \b matrix . 
+         * \brief Sets the Cell entity corresponding to a given position of the grid. 
          * \param row The row's index of the cell.
          * \param col The column's index of the cell
-         * \return The cell's reference corresponding to the position ( \b row , \b col ).
+         * \return A handle on the cell corresponding to the position ( \b row , \b col ).
         */
 
-        Cell& operator()(unsigned int row, unsigned int column){return matrix[row][column];} 
+        CellProxy operator()(unsigned int row, unsigned int column){return CellProxy{*this, row, column};} 
 
         /**
          * \brief Gets the size of rows of the grid. 
@@ -400,7 +618,7 @@ class Grid
          * \return The size of rows of the grid.
         */
 
-        unsigned int row_size() const {return matrix[0].size();}
+        unsigned int row_size() const {return _ncol;}
 
         /**
          * \brief Gets the size of columns of the grid . 
@@ -408,7 +626,15 @@ class Grid
          * \return The size of columns of the grid.
         */
 
-        unsigned int column_size() const {return matrix.size();}
+        unsigned int column_size() const {return static_cast<unsigned int>(_rows.size());}
+
+        /**
+         * \brief Gets the packed occupancy of a row.
+         * \param row The row's index.
+         * \return A word whose bit \b c is set when the cell ( \b row , \b c ) is full.
+        */
+
+        std::uint64_t row_mask(unsigned int row) const {return _rows[row];}
 
         /**
          * \brief Creates a piece of a given type and sets
@@ -421,10 +647,60 @@ class Grid
         Piece put_piece(PieceType ptype, unsigned int row=0);
 
         /**
-         * \brief Moves an existing piece, checks if the move is possible in the grid and
-         * moves the piece back the piece if it isn't. Also sets the grid accordingly
-         * to the result of the different movement. The length of the movement is 1
-         * by default.
+         * \brief Sets a given piece in the grid, without checking if its cells are empty
+         * (see can_place).
+         * \param piece The piece to set, lying inside the grid.
+         * \return
+        */
+
+        void put_piece(const Piece& piece);
+
+        /**
+         * \brief Clears the cells of a piece set in the grid.
+         * \param piece The piece to remove.
+         * \return
+        */
+
+        void remove_piece(const Piece& piece);
+
+        /**
+         * \brief Checks, without modifying the grid, if every block of a piece lies inside
+         * the grid on an empty cell. The piece is supposed not to be set in the grid yet.
+         * \param piece The piece to check.
+         * \return A boolean asserting if the piece can be placed in the grid.
+        */
+
+        bool can_place(const Piece& piece) const;
+
+        /**
+         * \brief Checks, without building the piece, if every block of a piece in a given
+         * state would lie inside the grid on an empty cell (see can_place). The rows covered
+         * by the piece are tested against its ShapeMask with the kernels of simd.h.
+         * \param type The type of the piece.
+         * \param rotation The rotation state of the piece, from 0 to 3.
+         * \param pivot_row The row of the pivot of the piece.
+         * \param pivot_col The column of the pivot of the piece.
+         * \return A boolean asserting if the piece can be placed in the grid.
+        */
+
+        bool fits(PieceType type, unsigned int rotation, unsigned int pivot_row, unsigned int pivot_col) const;
+
+        /**
+         * \brief Checks, without modifying the grid nor the piece, if a piece already set in
+         * the grid could perform a move. The cells occupied by the piece itself are
+         * considered as empty. The length of the movement is 1 by default.
+         * \param piece The piece that would be moved.
+         * \param move The move from Move that would be performed.
+         * \param length The length of the movement.
+         * \return A boolean asserting if the movement is possible.
+        */
+
+        bool test_move(const Piece& piece, Move move, unsigned int length=1) const;
+
+        /**
+         * \brief Moves an existing piece if the move is possible in the grid (see test_move)
+         * and sets the grid accordingly. The piece and the grid are left untouched if the
+         * move isn't possible. The length of the movement is 1 by default.
          * \param piece A reference to the piece that will be moved.
          * \param move The move from Move that has to be performed.
          * \param length The length of the movement.
@@ -433,6 +709,25 @@ class Grid
 
         bool move_piece(Piece& piece, Move move, unsigned int length=1); 
 
+        /**
+         * \brief Computes, without modifying the grid, how many rows a piece already set in
+         * the grid can fall. Only the lowest block of the piece in each of its columns is
+         * considered, its column being scanned downward with the occupancy words of the rows.
+         * \param piece The piece that would fall.
+         * \return The number of rows the piece can go down.
+        */
+
+        unsigned int drop_distance(const Piece& piece) const;
+
+        /**
+         * \brief Moves a piece already set in the grid straight down to its landing row.
+         * It's also performed by move_piece with Move::hard_drop.
+         * \param piece A reference to the piece that will be dropped.
+         * \return The number of rows the piece went down.
+        */
+
+        unsigned int hard_drop(Piece& piece);
+
         /**
          * \brief Checks if the grid has full rows and supresses them. Makes the other
          * rows fall accordingly.
@@ -442,20 +737,208 @@ class Grid
 
         bool update();
 
-    private :
-
-        std::vector< std::vector<Cell> > matrix; /**< A matrix of Cell entities. */
-        unsigned int _score; /**< The player's score currently associated with the grid. */
-
         /**
          * \brief A method that get the index of the grid's lines
-         * that are full.
+         * that are full. The list is maintained each time a cell is filled
+         * or cleared, so that no row has to be scanned.
          * \param 
          * \return A vector containing the indexes of full lines, from
          * top to bottom (from 0 to the maximum index). 
         */
 
-        std::vector<unsigned int> get_full_rows() const;
+        const std::vector<unsigned int>& get_full_rows() const {return _full_rows;}
+
+        /**
+         * \brief A getter for the height of a column : the number of rows from the bottom
+         * of the grid up to its highest full cell, included. It is maintained each time a
+         * cell is filled or cleared and when rows are suppressed. The columns left by a
+         * piece moved with move_piece() or hard_drop() are only lowered by the next call
+         * to update(), their height being an upper bound meanwhile.
+         * \param column The index of the column.
+         * \return The height of the column, 0 if it is empty.
+        */
+
+        unsigned int column_height(unsigned int column) const {return _heights[column];}
+
+        /**
+         * \brief A getter for the heights of all the columns (see column_height).
+         * \param
+         * \return A vector containing the height of each column, from left to right.
+        */
+
+        const std::vector<unsigned int>& column_heights() const {return _heights;}
+
+        /**
+         * \brief Counts the holes of a column : its empty cells below its highest full cell.
+         * \param column The index of the column.
+         * \return The number of holes of the column.
+        */
+
+        unsigned int column_holes(unsigned int column) const {return _heights[column]-_column_fill[column];}
+
+        /**
+         * \brief Counts the holes of the whole grid (see column_holes).
+         * \param
+         * \return The number of holes of the grid.
+        */
+
+        unsigned int holes() const;
+
+        /**
+         * \brief A getter for the Zobrist-style hash of the grid : the xor of a key for each
+         * non-empty row, drawn from its index and its occupancy word, kept up to date whenever
+         * a cell is filled or cleared. It depends on the size of the grid and on which cells are
+         * full, but neither on their colors nor on the score : two grids with the same
+         * full cells have the same hash, whatever the moves which led to them.
+         * \param
+         * \return The hash of the grid.
+        */
+
+        std::uint64_t hash() const {return _hash;}
+
+        /**
+         * \brief Switches the tracking of the changed cells on or off. It is off for a new grid
+         * and for a copy, so that only the grid shown to the player pays for it. Switching it
+         * on marks every cell as dirty.
+         * \param is_tracking A boolean asserting if the changed cells have to be tracked.
+         * \return
+        */
+
+        void set_dirty_tracking(bool is_tracking);
+
+        /**
+         * \brief Checks if the changed cells are tracked (see set_dirty_tracking).
+         * \param
+         * \return A boolean asserting if the changed cells are tracked.
+        */
+
+        bool is_tracking_dirty() const {return !_dirty.cells.empty();}
+
+        /**
+         * \brief A getter for the rows containing cells changed since the last call to
+         * clear_dirty(), for a renderer to redraw only these cells (see dirty_cells).
+         * It is always empty while the tracking is off.
+         * \param
+         * \return The indexes of the dirty rows, in the order they were changed.
+        */
+
+        const std::vector<unsigned int>& dirty_rows() const {return _dirty.rows;}
+
+        /**
+         * \brief A getter for the cells of a row changed since the last call to clear_dirty() :
+         * filled, cleared, recolored or moved by the suppression of full rows.
+         * \param row The row's index.
+         * \return A word whose bit \b c is set when the cell ( \b row , \b c ) is dirty.
+        */
+
+        std::uint64_t dirty_cells(unsigned int row) const {return is_tracking_dirty() ? _dirty.cells[row] : 0;}
+
+        /**
+         * \brief Forgets the changed cells, once they have been drawn.
+         * \param
+         * \return
+        */
+
+        void clear_dirty();
+
+    private :
+
+        /**
+         * \struct DirtyCells
+         * \brief The cells changed since the last call to clear_dirty(). A copy starts with
+         * the tracking off, so that the scratch grids copied by the searches don't carry it.
+        */
+
+        struct DirtyCells
+        {
+            std::vector<std::uint64_t> cells; /**< The changed cells of each row, empty while the tracking is off. */
+            std::vector<unsigned int> rows; /**< The indexes of the rows having changed cells. */
+
+            DirtyCells() = default;
+            DirtyCells(const DirtyCells&) {}
+            DirtyCells& operator=(const DirtyCells&) {cells.clear(); rows.clear(); return *this;}
+        };
+
+        std::vector<std::uint64_t> _rows; /**< The occupancy of each row, bit c being set when the cell of column c is full. */
+        std::vector<Color> _colors; /**< The colors of the cells, stored row after row in one contiguous buffer. */
+        std::vector<unsigned int> _row_index; /**< The row of the color buffer holding each row of the grid. */
+        unsigned int _ncol; /**< The number of columns of the grid. */
+        std::uint64_t _full_row; /**< The occupancy word of a full row. */
+        std::vector<unsigned int> _full_rows; /**< The indexes of the full rows, from top to bottom. */
+        std::vector<unsigned int> _heights; /**< The height of each column. */
+        std::vector<unsigned int> _column_fill; /**< The number of full cells of each column. */
+        std::uint64_t _lowered_columns; /**< The columns whose height is an upper bound, to be lowered by update(). */
+        unsigned int _score; /**< The player's score currently associated with the grid. */
+        std::uint64_t _hash; /**< The hash of the full cells of the grid (see hash()). */
+        DirtyCells _dirty; /**< The cells changed since the last call to clear_dirty(). */
+
+        /**
+         * \brief Fills a cell of the grid with a given color.
+         * \param row The row's index of the cell.
+         * \param column The column's index of the cell.
+         * \param color The color of the cell.
+         * \return
+        */
+
+        void fill_cell(unsigned int row, unsigned int column, Color color);
+
+        /**
+         * \brief Clears a cell of the grid.
+         * \param row The row's index of the cell.
+         * \param column The column's index of the cell.
+         * \param update_height A boolean asserting if the height of the column has to be
+         * lowered at once when its top cell is cleared. It's true by default.
+         * \return
+        */
+
+        void clear_cell(unsigned int row, unsigned int column, bool update_height=true);
+
+        /**
+         * \brief Lowers the height of a column, whose stored height is an upper bound,
+         * to its highest full cell by scanning the occupancy words of the rows below.
+         * \param column The index of the column.
+         * \return
+        */
+
+        void lower_height(unsigned int column);
+
+        /**
+         * \brief Marks cells of a row as changed.
+         * \param row The row's index.
+         * \param cells A word whose bit \b c is set when the cell ( \b row , \b c ) has changed.
+         * \return
+        */
+
+        void mark_dirty(unsigned int row, std::uint64_t cells)
+        {
+            if(cells==0 || _dirty.cells.empty()) return;
+            if(_dirty.cells[row]==0) _dirty.rows.push_back(row);
+            _dirty.cells[row]|=cells;
+        }
+
+        /**
+         * \brief Finds the top left cell of a shape in the grid.
+         * \param mask The shape.
+         * \param pivot_row The row of the pivot of the shape.
+         * \param pivot_col The column of the pivot of the shape.
+         * \param top The row of the top of the shape, set only if it lies inside the grid.
+         * \param left The column of the left of the shape, set only if it lies inside the grid.
+         * \return A boolean asserting if the shape lies inside the grid.
+        */
+
+        bool locate_shape(const ShapeMask& mask, unsigned int pivot_row, unsigned int pivot_col,
+                          unsigned int& top, unsigned int& left) const;
+
+        /**
+         * \brief Moves the cells of a piece set in the grid, without checking the move.
+         * The columns whose top cell is cleared are left for update() to lower.
+         * \param piece A reference to the piece that will be moved.
+         * \param move The move from Move that has to be performed.
+         * \param length The length of the movement.
+         * \return
+        */
+
+        void move_cells(Piece& piece, Move move, unsigned int length);
 };
 
 /**
@@ -470,17 +953,139 @@ class Grid
 std::string get_grid(Grid grid);
 
 /**
- * @brief Creates a random Tetris piece.
- *
- * Randomly selects one of the seven standard Tetrix pieces
- * (I, O, T, L, J, S, Z) and initializes it at row 0 and
- * the given column.
- *
- * @param col Initial column of the piece.
- * @return Piece A newly created random Tetris piece.
+ * \enum GeneratorPolicy
+ * \brief An enum class to choose how a PieceGenerator draws the next pieces.
  */
 
-PieceType createRandomPiece();
+enum class GeneratorPolicy : unsigned char {
+    uniform, /**< Each piece is drawn independently among the 7 types. */
+    bag, /**< The 7 types are shuffled in a bag which is emptied before being refilled. */
+    history /**< A piece is drawn again (a few times at most) while it is one of the last pieces dealt. */
+};
+
+/**
+ * \class PieceGenerator
+ * \brief A class which deals the sequence of PieceType of a game. The sequence only
+ * depends on the seed and the policy, so that a game can be replayed, sharded or
+ * compared. The pieces are drawn with a xoshiro256** generator and an unbiased
+ * bounded draw, and are generated in blocks into a queue of upcoming pieces.
+*/
+
+class PieceGenerator
+{
+    public :
+
+        static constexpr unsigned int max_history=16; /**< The maximum length of the history of the history policy. */
+        static constexpr unsigned int block_size=64; /**< The number of pieces generated at once in the queue. */
+
+        /**
+         * \brief Constructs the generator.
+         * Throws std::invalid_argument if \b history_size is greater than max_history.
+         * \param seed The seed of the sequence.
+         * \param policy The way the pieces are drawn. It's GeneratorPolicy::uniform by default.
+         * \param history_size The number of last pieces avoided by the history policy.
+         * \param history_tries The number of draws of the history policy before accepting a piece of the history.
+        */
+
+        PieceGenerator(std::uint64_t seed=0, GeneratorPolicy policy=GeneratorPolicy::uniform,
+                       unsigned int history_size=4, unsigned int history_tries=4);
+
+        /**
+         * \brief Restarts the sequence from a new seed, keeping the policy.
+         * \param seed The seed of the sequence.
+         * \return
+        */
+
+        void reset(std::uint64_t seed);
+
+        /**
+         * \brief Deals the next piece of the sequence.
+         * \param
+         * \return The type of the piece.
+        */
+
+        PieceType next();
+
+        /**
+         * \brief Gets an upcoming piece without dealing it.
+         * \param ahead The number of pieces dealt before the wanted one. peek(0) is the result
+         * of the next call to next().
+         * \return The type of the piece.
+        */
+
+        PieceType peek(std::size_t ahead=0);
+
+        /**
+         * \brief Deals several pieces at once.
+         * \param pieces The array in which the pieces are written.
+         * \param count The number of pieces to deal.
+         * \return
+        */
+
+        void fill(PieceType* pieces, std::size_t count);
+
+        /**
+         * \brief A getter for the seed of the sequence.
+         * \param
+         * \return The seed given at construction or to the last reset().
+        */
+
+        std::uint64_t seed() const {return _seed;}
+
+        /**
+         * \brief A getter for the policy of the generator.
+         * \param
+         * \return The GeneratorPolicy of the generator.
+        */
+
+        GeneratorPolicy policy() const {return _policy;}
+
+    private :
+        std::uint64_t _seed; /**< The seed of the sequence. */
+        GeneratorPolicy _policy; /**< The way the pieces are drawn. */
+        std::array<std::uint64_t, 4> _state; /**< The state of the xoshiro256** generator. */
+        std::array<PieceType, 7> _bag; /**< The shuffled bag of the bag policy. */
+        unsigned int _bag_position; /**< The number of pieces already taken from the bag. */
+        std::array<PieceType, max_history> _history; /**< The last pieces drawn by the history policy, as a ring. */
+        unsigned int _history_size; /**< The number of last pieces avoided by the history policy. */
+        unsigned int _history_tries; /**< The number of draws of the history policy before giving up. */
+        unsigned int _history_position; /**< The position of the oldest piece in the history ring. */
+        std::vector<PieceType> _queue; /**< The pieces generated in advance. */
+        std::size_t _queue_position; /**< The position of the next piece to deal in the queue. */
+
+        /**
+         * \brief Advances the xoshiro256** generator.
+         * \param
+         * \return 64 random bits.
+        */
+
+        std::uint64_t random();
+
+        /**
+         * \brief Draws an integer in [0, \b range ) without modulo bias (Lemire's method).
+         * \param range The number of possible values, greater than 0.
+         * \return The drawn integer.
+        */
+
+        unsigned int bounded(unsigned int range);
+
+        /**
+         * \brief Draws one piece according to the policy.
+         * \param
+         * \return The type of the piece.
+        */
+
+        PieceType generate();
+
+        /**
+         * \brief Appends a block of block_size new pieces to the queue, after having
+         * dropped the pieces already dealt.
+         * \param
+         * \return
+        */
+
+        void refill();
+};
 
 
 
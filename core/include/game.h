@@ -0,0 +1,291 @@
+/**
+ * \file game.h
+ * \brief
+ * This file contains the declaration of the Game class, the headless engine
+ * running a whole Tetris game on top of Grid, and of the events it emits.
+ * \author Alexandre Bleuler - Bonaventure Dohemeto
+ * \version 2.0
+ * \date 18/10/2026
+ */
+
+#ifndef CORE_GAME
+#define CORE_GAME
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "core_class.h"
+
+/**
+ * \enum GameEvent
+ * \brief An enum class describing what happened during the game, so that a user
+ * interface can react to it (sounds, animations...) without the core depending on it.
+ */
+
+enum class GameEvent{
+    piece_locked, /**< The current piece couldn't go down anymore and has been locked in the grid. */
+    lines_cleared, /**< At least one full row has been suppressed. */
+    level_up, /**< The score went over the threshold of the next level, the gravity became faster. */
+    game_over /**< The game is over. */
+};
+
+/**
+ * \struct TimedMove
+ * \brief A move of the player and the tick at which it was applied, as recorded by a Game.
+ */
+
+struct TimedMove
+{
+    std::uint64_t tick; /**< The number of ticks played before the move. */
+    Move move; /**< The move applied to the current piece. */
+};
+
+/**
+ * \class Game
+ * \brief A class which runs a Tetris game without any user interface. The game only
+ * advances through explicit calls to tick() and input(), so that it can be played
+ * in real time by the UI (60 ticks per second) or simulated as fast as possible.
+ * Everything noticeable that happens is stored as a GameEvent until clear_events().
+*/
+
+class Game
+{
+    public :
+
+        /**
+         * \brief Constructs the game and spawns its first piece.
+         * \param nrow The number of rows of the grid. It's 20 by default.
+         * \param ncol The number of columns of the grid. It's 10 by default.
+         * \param seed The seed of the random generator of the pieces.
+         * \param ticks_per_second The number of ticks corresponding to one second of play.
+         * It sets the gravity speed and is 60 by default.
+         * \param policy The way the pieces are drawn. It's GeneratorPolicy::uniform by default.
+        */
+
+        Game(unsigned int nrow=20, unsigned int ncol=10, std::uint64_t seed=0, unsigned int ticks_per_second=60,
+             GeneratorPolicy policy=GeneratorPolicy::uniform);
+
+        /**
+         * \brief Restarts the game from an empty grid with a new seed.
+         * \param seed The seed of the random generator of the pieces.
+         * \return
+        */
+
+        void reset(std::uint64_t seed);
+
+        /**
+         * \brief Applies a move of the player to the current piece. Upward moves
+         * aren't allowed and nothing happens once the game is over. A hard drop
+         * moves the piece to its landing row and locks it at once.
+         * \param move The move from Move that has to be performed.
+         * \return A boolean asserting if the movement was possible.
+        */
+
+        bool input(Move move);
+
+        /**
+         * \brief Advances the game by one tick. The current piece goes down by one row
+         * each gravity_interval() ticks and is locked when it can't go down anymore.
+         * \param
+         * \return
+        */
+
+        void tick();
+
+        /**
+         * \brief Advances the game by several ticks, as \b ticks calls to tick() would.
+         * The ticks between two gravity steps are skipped at once, which makes the
+         * fast-forward of a replay cost one step per row fallen instead of one per tick.
+         * \param ticks The number of ticks to play.
+         * \return
+        */
+
+        void advance(std::uint64_t ticks);
+
+        /**
+         * \brief A getter for the grid of the game.
+         * \param
+         * \return A constant reference to the grid.
+        */
+
+        const Grid& grid() const {return _grid;}
+
+        /**
+         * \brief Forgets the cells of the grid changed since the last call, once the grid
+         * has been drawn (see Grid::dirty_rows).
+         * \param
+         * \return
+        */
+
+        void clear_dirty() {_grid.clear_dirty();}
+
+        /**
+         * \brief Switches the tracking of the changed cells of the grid on or off, for a
+         * renderer drawing only these cells (see Grid::set_dirty_tracking). It is kept when
+         * the game is reset.
+         * \param is_tracking A boolean asserting if the changed cells have to be tracked.
+         * \return
+        */
+
+        void set_dirty_tracking(bool is_tracking) {_grid.set_dirty_tracking(is_tracking);}
+
+        /**
+         * \brief A getter for the piece controlled by the player.
+         * \param
+         * \return A constant reference to the current piece.
+        */
+
+        const Piece& current() const {return _current;}
+
+        /**
+         * \brief A getter for the type of the piece that will come after the current one.
+         * \param
+         * \return The type of the next piece.
+        */
+
+        PieceType next() const {return _next;}
+
+        /**
+         * \brief Gets the types of the upcoming pieces, without changing the sequence of the game.
+         * \param pieces The array in which the types are written, the next piece first.
+         * \param count The number of upcoming pieces wanted.
+         * \return
+        */
+
+        void preview(PieceType* pieces, std::size_t count);
+
+        /**
+         * \brief A getter for the seed of the game.
+         * \param
+         * \return The seed of the piece generator.
+        */
+
+        std::uint64_t seed() const {return _generator.seed();}
+
+        /**
+         * \brief A getter for the way the pieces of the game are drawn.
+         * \param
+         * \return The GeneratorPolicy of the piece generator.
+        */
+
+        GeneratorPolicy generator_policy() const {return _generator.policy();}
+
+        /**
+         * \brief Checks if the game is over.
+         * \param
+         * \return A boolean asserting if the game is over.
+        */
+
+        bool is_over() const {return _is_over;}
+
+        /**
+         * \brief A getter for the score of the player.
+         * \param
+         * \return The score of the grid.
+        */
+
+        unsigned int score() const {return _grid.score();}
+
+        /**
+         * \brief A getter for the level of the game, starting at 0.
+         * \param
+         * \return The number of level ups since the beginning of the game.
+        */
+
+        unsigned int level() const {return _level;}
+
+        /**
+         * \brief A getter for the number of ticks since the beginning of the game.
+         * \param
+         * \return The number of ticks.
+        */
+
+        std::uint64_t tick_count() const {return _ticks;}
+
+        /**
+         * \brief A getter for the number of pieces locked since the beginning of the game.
+         * \param
+         * \return The number of locked pieces.
+        */
+
+        std::uint64_t piece_count() const {return _pieces;}
+
+        /**
+         * \brief A getter for the number of ticks corresponding to one second of play.
+         * \param
+         * \return The number of ticks per second.
+        */
+
+        unsigned int ticks_per_second() const {return _ticks_per_second;}
+
+        /**
+         * \brief Gets the number of ticks between two gravity steps at the current level.
+         * \param
+         * \return The number of ticks, at least 1.
+        */
+
+        unsigned int gravity_interval() const;
+
+        /**
+         * \brief A getter for the events that happened since the last call to clear_events().
+         * \param
+         * \return The events, from the oldest to the most recent.
+        */
+
+        const std::vector<GameEvent>& events() const {return _events;}
+
+        /**
+         * \brief Forgets the events that happened so far.
+         * \param
+         * \return
+        */
+
+        void clear_events() {_events.clear();}
+
+        /**
+         * \brief Starts or stops the recording of the moves applied by input(). Only the
+         * moves that were possible are recorded, the other ones having no effect.
+         * The record is emptied by reset().
+         * \param is_recording A boolean asserting if the moves have to be recorded.
+         * \return
+        */
+
+        void set_recording(bool is_recording) {_is_recording=is_recording;}
+
+        /**
+         * \brief A getter for the moves recorded since the beginning of the game.
+         * \param
+         * \return The recorded moves, in the order they were applied.
+        */
+
+        const std::vector<TimedMove>& recorded_moves() const {return _recorded_moves;}
+
+    private :
+        Grid _grid; /**< The grid of the game. */
+        Piece _current; /**< The piece controlled by the player. */
+        PieceType _next; /**< The type of the next piece. */
+        PieceGenerator _generator; /**< The generator of the sequence of pieces. */
+        unsigned int _ticks_per_second; /**< The number of ticks corresponding to one second of play. */
+        std::uint64_t _ticks; /**< The number of ticks since the beginning of the game. */
+        std::uint64_t _pieces; /**< The number of locked pieces since the beginning of the game. */
+        unsigned int _gravity_ticks; /**< The number of ticks since the last gravity step. */
+        double _time_decrease_rate; /**< The relative decrease of the gravity interval. */
+        double _score_threshold; /**< The score to go over to reach the next level. */
+        unsigned int _level; /**< The number of level ups since the beginning of the game. */
+        bool _is_over; /**< A boolean indicating if the game is over. */
+        std::vector<GameEvent> _events; /**< The events that happened since the last call to clear_events(). */
+        bool _is_recording=false; /**< A boolean indicating if the moves are recorded. */
+        std::vector<TimedMove> _recorded_moves; /**< The moves recorded since the beginning of the game. */
+
+        /**
+         * \brief Locks the current piece : suppresses full rows, updates the level
+         * and spawns the next piece unless the game is over.
+         * \param
+         * \return
+        */
+
+        void lock();
+};
+
+#endif
@@ -0,0 +1,121 @@
+/**
+ * \file parallel.h
+ * \brief
+ * This file contains the declaration of a work-stealing parallel loop used to
+ * spread independent jobs (simulated games, search branches...) over the cores.
+ * \author Alexandre Bleuler - Bonaventure Dohemeto
+ * \version 2.0
+ * \date 18/10/2026
+ */
+
+#ifndef CORE_PARALLEL
+#define CORE_PARALLEL
+
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/**
+ * \brief Gets the number of threads to use for a requested number of threads.
+ * \param threads The requested number of threads, 0 meaning one per core.
+ * \return The number of threads, at least 1.
+*/
+
+unsigned int thread_count(unsigned int threads);
+
+/**
+ * \brief Calls \b body for every index of [0, \b count ) on \b threads worker threads.
+ * Each worker starts with a contiguous share of the indexes and, once its share is
+ * done, steals half of the remaining indexes of another worker. Shares are updated
+ * with atomic operations only, no lock is taken. With a single thread, the indexes
+ * are processed in order on the calling thread.
+ * \param count The number of indexes, smaller than 2^32.
+ * \param threads The number of worker threads, 0 meaning one per core.
+ * \param body The job, called with the index of the worker (from 0 to the number
+ * of threads excluded) and the index to process.
+ * \return
+*/
+
+void parallel_for(std::size_t count, unsigned int threads,
+                  const std::function<void(unsigned int worker, std::size_t index)>& body);
+
+/**
+ * \class ThreadPool
+ * \brief A set of worker threads kept alive between parallel loops, for loops too short
+ * to pay for the creation of their threads (a search run at each move, for instance).
+ * The loops share their indexes between the workers as parallel_for does.
+*/
+
+class ThreadPool
+{
+    public :
+
+        /**
+         * \brief Starts the worker threads.
+         * \param threads The number of workers, the calling thread included, 0 meaning one per core.
+        */
+
+        explicit ThreadPool(unsigned int threads=0);
+
+        /**
+         * \brief Stops and joins the worker threads.
+        */
+
+        ~ThreadPool();
+
+        ThreadPool(const ThreadPool&) = delete;
+        ThreadPool& operator=(const ThreadPool&) = delete;
+
+        /**
+         * \brief A getter for the number of workers.
+         * \param
+         * \return The number of workers, the calling thread included.
+        */
+
+        unsigned int size() const {return _size;}
+
+        /**
+         * \brief Calls \b body for every index of [0, \b count ) on the workers of the pool
+         * (see ::parallel_for). The calling thread is the worker 0. Only one loop can run
+         * at a time.
+         * \param count The number of indexes, smaller than 2^32.
+         * \param body The job, called with the index of the worker and the index to process.
+         * \return
+        */
+
+        void parallel_for(std::size_t count, const std::function<void(unsigned int worker, std::size_t index)>& body);
+
+        /**
+         * \struct Share
+         * \brief The indexes left to a worker, defined in parallel.cpp.
+        */
+
+        struct Share;
+
+    private :
+        unsigned int _size; /**< The number of workers, the calling thread included. */
+        std::unique_ptr<Share[]> _shares; /**< The share of indexes of each worker. */
+        std::vector<std::thread> _threads; /**< The worker threads, the calling thread excluded. */
+        std::mutex _mutex; /**< The mutex protecting the fields below. */
+        std::condition_variable _start; /**< Signals a new loop or the stop of the pool to the workers. */
+        std::condition_variable _done; /**< Signals the end of the loop to the calling thread. */
+        const std::function<void(unsigned int, std::size_t)>* _body=nullptr; /**< The job of the current loop. */
+        std::uint64_t _loop=0; /**< The number of loops started. */
+        unsigned int _running=0; /**< The number of workers still busy with the current loop. */
+        bool _is_stopping=false; /**< A boolean indicating if the workers have to stop. */
+
+        /**
+         * \brief The loop of a worker thread, waiting for the parallel loops to run.
+         * \param worker The index of the worker.
+         * \return
+        */
+
+        void work(unsigned int worker);
+};
+
+#endif
@@ -0,0 +1,129 @@
+/**
+ * \file placement.h
+ * \brief
+ * This file contains the declaration of the PlacementFinder class, which enumerates
+ * every position in which a piece can be locked in a grid, and of the Placement struct.
+ * \author Alexandre Bleuler - Bonaventure Dohemeto
+ * \version 2.0
+ * \date 18/10/2026
+ */
+
+#ifndef CORE_PLACEMENT
+#define CORE_PLACEMENT
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "core_class.h"
+
+/**
+ * \struct Placement
+ * \brief A position in which a piece can be locked : its rotation state and the
+ * coordinates of its pivot.
+ */
+
+struct Placement
+{
+    PieceType type; /**< The type of the piece. */
+    unsigned int rotation; /**< The rotation state of the piece, from 0 to 3. */
+    unsigned int row; /**< The row of the pivot of the piece. */
+    unsigned int column; /**< The column of the pivot of the piece. */
+
+    /**
+     * \brief Builds the piece lying at the placement.
+     * \param
+     * \return The piece.
+    */
+
+    Piece piece() const {return Piece{type, row, column, rotation};}
+};
+
+/**
+ * \class PlacementFinder
+ * \brief A class which enumerates the distinct positions in which a piece can be locked,
+ * with a breadth-first search over the states (rotation, row, column) of the piece
+ * reachable with the moves of the player. Collisions are checked with Grid::fits, which
+ * tests the shape mask of the piece against the occupancy rows, without modifying the grid. Placements covering the same cells (the rotations of the
+ * O piece, or the opposite states of the I, S and Z pieces) are only reported once.
+ * The buffers of the search are kept from one call to the other, so that no allocation
+ * happens once they have reached the size of the grid.
+*/
+
+class PlacementFinder
+{
+    public :
+
+        /**
+         * \brief Finds the placements of a piece starting from a given state.
+         * \param grid The grid, which mustn't contain the piece.
+         * \param start The piece in its starting state.
+         * \return The placements, in the order of their discovery, empty if the
+         * starting state isn't free. The vector is reused by the next call.
+        */
+
+        const std::vector<Placement>& find(const Grid& grid, const Piece& start);
+
+        /**
+         * \brief Finds the placements of a piece appearing where Grid::put_piece sets it :
+         * on the first row, in the middle of the grid, without rotation.
+         * \param grid The grid, which mustn't contain the piece.
+         * \param type The type of the piece.
+         * \return The placements, in the order of their discovery. The vector is reused by the next call.
+        */
+
+        const std::vector<Placement>& find(const Grid& grid, PieceType type);
+
+        /**
+         * \brief A getter for the placements found by the last search.
+         * \param
+         * \return The placements.
+        */
+
+        const std::vector<Placement>& placements() const {return _placements;}
+
+        /**
+         * \brief Gets the shortest sequence of moves leading the piece from its starting
+         * state to a placement found by the last search.
+         * \param index The index of the placement in placements().
+         * \param moves The vector in which the moves are written, from the first to the last.
+         * \return
+        */
+
+        void path(std::size_t index, std::vector<Move>& moves) const;
+
+    private :
+        unsigned int _nrow=0; /**< The number of rows of the grid of the last search. */
+        unsigned int _ncol=0; /**< The number of columns of the grid of the last search. */
+        std::uint32_t _generation=0; /**< The number of the search, marking the states it visited. */
+        std::vector<std::uint32_t> _visited; /**< For each state, the last search having visited it. */
+        std::vector<std::uint32_t> _locked; /**< For each state, the last search having locked a piece covering its cells. */
+        std::vector<std::uint32_t> _parent; /**< For each visited state, the state it was reached from. */
+        std::vector<Move> _parent_move; /**< For each visited state, the move it was reached with. */
+        std::vector<std::uint32_t> _queue; /**< The states to visit, in the order of their discovery. */
+        std::vector<Placement> _placements; /**< The placements found by the last search. */
+        std::vector<std::uint32_t> _placement_states; /**< The state of each placement. */
+
+        /**
+         * \brief Sizes the buffers for a grid and starts a new generation of marks.
+         * \param grid The grid of the search.
+         * \return
+        */
+
+        void prepare(const Grid& grid);
+
+        /**
+         * \brief Gets the index of a state.
+         * \param rotation The rotation state.
+         * \param row The row of the pivot.
+         * \param column The column of the pivot.
+         * \return The index of the state in the buffers.
+        */
+
+        std::uint32_t state(unsigned int rotation, unsigned int row, unsigned int column) const
+        {
+            return (rotation*_nrow+row)*_ncol+column;
+        }
+};
+
+#endif
@@ -0,0 +1,111 @@
+/**
+ * \file replay.h
+ * \brief
+ * This file contains the declarations used to record a game in a compact binary
+ * replay (its seed and the moves of the player with their tick) and to play it back
+ * without any rendering, as fast as possible.
+ * \author Alexandre Bleuler - Bonaventure Dohemeto
+ * \version 2.0
+ * \date 18/10/2026
+ */
+
+#ifndef CORE_REPLAY
+#define CORE_REPLAY
+
+#include <cstdint>
+#include <istream>
+#include <ostream>
+#include <string>
+#include <vector>
+
+#include "game.h"
+
+/**
+ * \struct Replay
+ * \brief Everything needed to play a game again : the parameters of the game, the
+ * moves of the player and the final tick and score used to check the playback.
+ */
+
+struct Replay
+{
+    std::uint64_t seed=0; /**< The seed of the piece generator. */
+    GeneratorPolicy generator=GeneratorPolicy::uniform; /**< The way the pieces were drawn. */
+    unsigned int rows=20; /**< The number of rows of the grid. */
+    unsigned int columns=10; /**< The number of columns of the grid. */
+    unsigned int ticks_per_second=60; /**< The number of ticks per second of play, which sets the gravity. */
+    std::vector<TimedMove> moves; /**< The moves of the player, in the order they were applied. */
+    std::uint64_t ticks=0; /**< The number of ticks played when the replay was made. */
+    unsigned int score=0; /**< The score when the replay was made. */
+};
+
+/**
+ * \struct PlaybackResult
+ * \brief The outcome of the playback of a replay.
+ */
+
+struct PlaybackResult
+{
+    unsigned int score=0; /**< The score at the end of the playback. */
+    std::uint64_t ticks=0; /**< The number of ticks played. */
+    std::uint64_t pieces=0; /**< The number of locked pieces. */
+    bool is_over=false; /**< A boolean indicating if the game is over. */
+    bool is_valid=false; /**< False if a move was impossible or if the score or the ticks differ from the replay. */
+};
+
+/**
+ * \brief Makes the replay of a game which recorded its moves (see Game::set_recording)
+ * since its beginning.
+ * \param game The recorded game.
+ * \return The replay of the game up to its current tick.
+*/
+
+Replay make_replay(const Game& game);
+
+/**
+ * \brief Writes a replay in its binary format : a header (magic, version, generator
+ * policy, seed and dimensions), then each move as the varint of its tick delta
+ * followed by one byte, and finally the varints of the final tick and score.
+ * \param out The binary stream on which the replay is written.
+ * \param replay The replay to write.
+ * \return
+*/
+
+void write_replay(std::ostream& out, const Replay& replay);
+
+/**
+ * \brief Reads a replay written by write_replay().
+ * \param in The binary stream from which the replay is read.
+ * \param replay The replay, only meaningful if the reading succeeded.
+ * \return A boolean asserting if the stream held a valid replay.
+*/
+
+bool read_replay(std::istream& in, Replay& replay);
+
+/**
+ * \brief Writes a replay in a file.
+ * \param path The path of the file.
+ * \param replay The replay to write.
+ * \return A boolean asserting if the file was written.
+*/
+
+bool save_replay(const std::string& path, const Replay& replay);
+
+/**
+ * \brief Reads a replay from a file.
+ * \param path The path of the file.
+ * \param replay The replay, only meaningful if the reading succeeded.
+ * \return A boolean asserting if the file held a valid replay.
+*/
+
+bool load_replay(const std::string& path, Replay& replay);
+
+/**
+ * \brief Plays a replay again without rendering. The ticks between two moves are
+ * fast-forwarded with Game::advance().
+ * \param replay The replay to play.
+ * \return The outcome of the playback, valid if it reached the recorded tick and score.
+*/
+
+PlaybackResult play_replay(const Replay& replay);
+
+#endif
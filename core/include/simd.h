@@ -0,0 +1,95 @@
+/**
+ * \file simd.h
+ * \brief
+ * This file contains the declarations of the kernels working on the occupancy words
+ * of the rows of a grid (see Grid::row_mask), with vector implementations chosen at
+ * runtime according to the processor and a scalar fallback.
+ * \author Alexandre Bleuler - Bonaventure Dohemeto
+ * \version 2.0
+ * \date 18/10/2026
+ */
+
+#ifndef CORE_SIMD
+#define CORE_SIMD
+
+#include <cstddef>
+#include <cstdint>
+
+/**
+ * \namespace simd
+ * \brief The kernels on occupancy words and the selection of their implementation.
+ */
+
+namespace simd
+{
+    /**
+     * \enum Level
+     * \brief The instruction sets the kernels can be implemented with.
+     */
+
+    enum class Level : unsigned char {
+        scalar, /**< Plain 64 bits operations, available everywhere. */
+        sse41, /**< Two rows at a time with SSE4.1. */
+        avx2 /**< Four rows at a time with AVX2. */
+    };
+
+    /**
+     * \brief Gets the best level supported by the processor.
+     * \param
+     * \return The best supported level.
+    */
+
+    Level detected_level();
+
+    /**
+     * \brief Gets the level of the kernels in use, the best supported one by default.
+     * \param
+     * \return The level in use.
+    */
+
+    Level level();
+
+    /**
+     * \brief Selects the level of the kernels, to compare them in tests and benchmarks.
+     * It mustn't be called while kernels run on other threads.
+     * \param level The level to use.
+     * \return A boolean asserting if the level is supported, the level in use being
+     * left unchanged otherwise.
+    */
+
+    bool set_level(Level level);
+
+    /**
+     * \brief Gets the name of a level.
+     * \param level The level.
+     * \return The name of the level : "scalar", "sse4.1" or "avx2".
+    */
+
+    const char* level_name(Level level);
+
+    /**
+     * \brief Looks for the first row sharing a cell with a mask, as when scanning a
+     * column down to its highest full cell.
+     * \param rows The occupancy words of the rows.
+     * \param begin The index of the first row to test.
+     * \param end The index following the last row to test.
+     * \param mask The cells to look for.
+     * \return The index of the first row of [\b begin, \b end) sharing a cell with \b mask,
+     * \b end if there is none.
+    */
+
+    std::size_t first_intersecting_row(const std::uint64_t* rows, std::size_t begin, std::size_t end, std::uint64_t mask);
+
+    /**
+     * \brief Tests whether a shape of at most 4 rows overlaps full cells of the grid.
+     * \param rows The occupancy words of the rows covered by the shape, from its top row.
+     * \param masks The cells of the shape in each of its rows, 4 words being readable.
+     * \param count The number of rows of the shape, from 1 to 4.
+     * \param shift The column of the bit 0 of the masks.
+     * \return A boolean asserting if a row shares a cell with the shifted mask of its row.
+    */
+
+    bool rows_intersect(const std::uint64_t* rows, const std::uint64_t* masks, unsigned int count, unsigned int shift);
+}
+
+#endif
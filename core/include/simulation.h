@@ -0,0 +1,179 @@
+/**
+ * \file simulation.h
+ * \brief
+ * This file contains the declarations used to run batches of headless games :
+ * the move policies playing them, the configuration of a batch and its results.
+ * \author Alexandre Bleuler - Bonaventure Dohemeto
+ * \version 2.0
+ * \date 18/10/2026
+ */
+
+#ifndef CORE_SIMULATION
+#define CORE_SIMULATION
+
+#include <cstdint>
+#include <memory>
+#include <ostream>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "game.h"
+
+/**
+ * \class MovePolicy
+ * \brief An interface for the players of simulated games. Before each tick, the
+ * policy is asked for the move to perform on the current piece.
+*/
+
+class MovePolicy
+{
+    public :
+
+        virtual ~MovePolicy() = default;
+
+        /**
+         * \brief Prepares the policy for a new game.
+         * \param seed The seed of the game, to be used by policies making random choices.
+         * \return
+        */
+
+        virtual void reset(std::uint64_t seed) {(void)seed;}
+
+        /**
+         * \brief Chooses the move to perform before the next tick.
+         * \param game The game being played.
+         * \return The move to perform, Move::none to let the piece fall.
+        */
+
+        virtual Move choose(const Game& game) = 0;
+};
+
+/**
+ * \class IdlePolicy
+ * \brief A policy which never moves : the pieces fall in the middle of the grid.
+*/
+
+class IdlePolicy : public MovePolicy
+{
+    public :
+        Move choose(const Game& game) override {(void)game; return Move::none;}
+};
+
+/**
+ * \class RandomPolicy
+ * \brief A policy performing random moves (left, right, down, rotations) or nothing.
+*/
+
+class RandomPolicy : public MovePolicy
+{
+    public :
+        void reset(std::uint64_t seed) override {_random.seed(seed);}
+        Move choose(const Game& game) override;
+
+    private :
+        std::mt19937_64 _random; /**< The random generator of the moves. */
+};
+
+/**
+ * \brief Creates a policy from its name.
+ * \param name The name of the policy : "idle", "random" or "ai" (see AiPolicy).
+ * \return The policy, or nullptr if the name is unknown.
+*/
+
+std::unique_ptr<MovePolicy> make_policy(const std::string& name);
+
+/**
+ * \brief Gets a piece generator policy from its name.
+ * \param name The name of the policy : "uniform", "bag" or "history".
+ * \param policy The policy, set only if the name is known.
+ * \return A boolean asserting if the name is known.
+*/
+
+bool generator_policy_from_name(const std::string& name, GeneratorPolicy& policy);
+
+/**
+ * \struct SimulationConfig
+ * \brief The parameters of a batch of simulated games.
+*/
+
+struct SimulationConfig
+{
+    unsigned int games=1000; /**< The number of games to play. */
+    std::uint64_t seed=0; /**< The seed from which the seed of every game is derived. */
+    unsigned int rows=20; /**< The number of rows of the grids. */
+    unsigned int columns=10; /**< The number of columns of the grids. */
+    unsigned int ticks_per_second=60; /**< The number of ticks per second of play, which sets the gravity. */
+    std::uint64_t max_ticks=1000000; /**< The tick budget of a game, after which it is stopped. */
+    std::string policy="random"; /**< The name of the policy playing the games. */
+    GeneratorPolicy generator=GeneratorPolicy::uniform; /**< The way the pieces of the games are drawn. */
+    unsigned int threads=0; /**< The number of threads sharing the games, 0 meaning one per core. */
+};
+
+/**
+ * \struct GameResult
+ * \brief The outcome of one simulated game.
+*/
+
+struct GameResult
+{
+    std::uint64_t seed=0; /**< The seed of the game. */
+    unsigned int score=0; /**< The final score. */
+    std::uint64_t pieces=0; /**< The number of locked pieces. */
+    std::uint64_t ticks=0; /**< The number of ticks played. */
+    bool is_over=false; /**< False if the game was stopped by the tick budget. */
+};
+
+/**
+ * \struct SimulationResult
+ * \brief The outcome of a batch of simulated games.
+*/
+
+struct SimulationResult
+{
+    std::vector<GameResult> games; /**< The results of the games, in the order of their index. */
+    double seconds=0; /**< The wall-clock duration of the batch. */
+};
+
+/**
+ * \brief Derives the seed of a game of a batch, so that every game can be replayed alone.
+ * \param seed The seed of the batch.
+ * \param index The index of the game in the batch.
+ * \return The seed of the game.
+*/
+
+std::uint64_t game_seed(std::uint64_t seed, std::uint64_t index);
+
+/**
+ * \brief Plays one game until it is over or its tick budget is spent.
+ * \param config The parameters of the game (grid size, gravity, tick budget).
+ * \param seed The seed of the game.
+ * \param policy The policy playing the game.
+ * \return The outcome of the game.
+*/
+
+GameResult play_game(const SimulationConfig& config, std::uint64_t seed, MovePolicy& policy);
+
+/**
+ * \brief Plays a batch of games, shared between config.threads threads with a
+ * work-stealing loop (see parallel_for). Each thread owns its policy and every game
+ * owns its grid and piece generator, seeded from the index of the game, so that the
+ * results don't depend on the number of threads. Each game writes its own slot of
+ * the results, which are only aggregated once every thread is done.
+ * \param config The parameters of the batch.
+ * \return The outcome of the batch. It contains no game if the policy is unknown.
+*/
+
+SimulationResult run_simulation(const SimulationConfig& config);
+
+/**
+ * \brief Writes the throughput (games and pieces per second) and the score
+ * distribution of a batch.
+ * \param out The stream on which the report is written.
+ * \param result The outcome of the batch.
+ * \return
+*/
+
+void print_report(std::ostream& out, const SimulationResult& result);
+
+#endif
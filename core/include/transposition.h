@@ -0,0 +1,102 @@
+/**
+ * \file transposition.h
+ * \brief
+ * This file contains the declaration of the transposition table, a fixed-size cache
+ * of the scores of the searched grids, shared without lock between threads.
+ * \author Alexandre Bleuler - Bonaventure Dohemeto
+ * \version 2.0
+ * \date 18/10/2026
+ */
+
+#ifndef CORE_TRANSPOSITION
+#define CORE_TRANSPOSITION
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+
+#include "core_class.h"
+
+/**
+ * \class TranspositionTable
+ * \brief A cache of scores indexed by a 64 bits key, typically the hash of a grid
+ * (see Grid::hash) mixed with the pieces still to place. Each key has a single slot,
+ * a new score replacing the previous one. The slots are read and written without lock :
+ * a slot stores its score and the key xored with the score, so that a slot torn by
+ * concurrent writes is seen as a miss.
+*/
+
+class TranspositionTable
+{
+    public :
+
+        /**
+         * \brief Constructs an empty table.
+         * \param size The number of slots, rounded up to a power of two.
+        */
+
+        explicit TranspositionTable(std::size_t size=std::size_t{1}<<16);
+
+        /**
+         * \brief Computes the key of a grid and the pieces still to place in it.
+         * \param grid_hash The hash of the grid.
+         * \param piece The type of the piece to place.
+         * \param next The type of the piece following it.
+         * \return The key.
+        */
+
+        static std::uint64_t key(std::uint64_t grid_hash, PieceType piece, PieceType next);
+
+        /**
+         * \brief Looks for the score of a key.
+         * \param key The key.
+         * \param score The score, set only if the key is found.
+         * \return A boolean asserting if the key is found.
+        */
+
+        bool probe(std::uint64_t key, double& score) const;
+
+        /**
+         * \brief Stores the score of a key, in place of the one sharing its slot.
+         * \param key The key.
+         * \param score The score.
+         * \return
+        */
+
+        void store(std::uint64_t key, double score);
+
+        /**
+         * \brief Empties the table. It mustn't be used by other threads meanwhile.
+         * \param
+         * \return
+        */
+
+        void clear();
+
+        /**
+         * \brief A getter for the number of slots.
+         * \param
+         * \return The number of slots.
+        */
+
+        std::size_t size() const {return _mask+1;}
+
+    private :
+
+        /**
+         * \struct Slot
+         * \brief A slot of the table.
+        */
+
+        struct Slot
+        {
+            std::atomic<std::uint64_t> check{0}; /**< The key xored with the data. */
+            std::atomic<std::uint64_t> data{0}; /**< The bits of the score. */
+        };
+
+        std::unique_ptr<Slot[]> _slots; /**< The slots. */
+        std::size_t _mask; /**< The number of slots minus one, to index them by the low bits of the keys. */
+};
+
+#endif
@@ -0,0 +1,222 @@
+/**
+ * \file ai.cpp
+ * \brief This file contains the definitions of the automatic player.
+ * \author Alexandre Bleuler - Bonaventure Dohemeto
+ * \version 2.0
+ * \date 18/10/2026
+ */
+
+#include <algorithm>
+#include <atomic>
+#include <bitset>
+#include <limits>
+
+#include "ai.h"
+
+double evaluate_grid(const Grid& grid, unsigned int lines, const AiWeights& weights)
+{
+    const std::vector<unsigned int>& heights=grid.column_heights();
+    unsigned int height=0;
+    unsigned int bumpiness=0;
+    for(std::size_t column=0; column<heights.size(); ++column)
+    {
+        height+=heights[column];
+        if(column>0)
+        {
+            bumpiness+= heights[column]>heights[column-1] ? heights[column]-heights[column-1] : heights[column-1]-heights[column];
+        }
+    }
+    return weights.height*height + weights.lines*lines + weights.holes*grid.holes() + weights.bumpiness*bumpiness;
+}
+
+AiPolicy::AiPolicy(const AiWeights& weights, std::chrono::microseconds budget, unsigned int threads)
+: _weights{weights}, _budget{budget}, _workers(thread_count(threads)),
+  _can_prune{weights.height<=0 && weights.holes<=0 && weights.bumpiness<=0 && weights.lines>=0}
+{
+    if(_workers.size()>1) _pool=std::make_unique<ThreadPool>(static_cast<unsigned int>(_workers.size()));
+}
+
+void AiPolicy::reset(std::uint64_t seed)
+{
+    (void)seed;
+    _moves.clear();
+    _next_move=0;
+    _planned_piece=~std::uint64_t{0};
+}
+
+bool AiPolicy::lock(Grid& grid, const Piece& piece, unsigned int& lines)
+{
+    grid.put_piece(piece);
+    lines=grid.get_full_rows().size();
+    return grid.update();
+}
+
+double AiPolicy::upper_bound(const Grid& grid, unsigned int lines) const
+{
+    // The next piece adds 4 cells. Without suppressing a row, it can't lower a column but
+    // can fill up to 4 holes. Otherwise the sum of the heights is at least the number of
+    // filled cells, and only the rows missing at most 4 cells can be suppressed.
+    unsigned int height=0;
+    for(unsigned int column_height : grid.column_heights()) height+=column_height;
+    unsigned int holes=grid.holes();
+    unsigned int cells=height-holes;
+    unsigned int ncol=grid.row_size();
+    unsigned int candidate_rows=0;
+    for(unsigned int row=0; row<grid.column_size() && candidate_rows<4; ++row)
+    {
+        if(std::bitset<64>{grid.row_mask(row)}.count()+4>=ncol) ++candidate_rows;
+    }
+
+    double bound=_weights.lines*lines + _weights.height*height + _weights.holes*(holes>4 ? holes-4 : 0);
+    for(unsigned int second_lines=1; second_lines<=candidate_rows; ++second_lines)
+    {
+        unsigned int remaining= cells+4>second_lines*ncol ? cells+4-second_lines*ncol : 0;
+        bound=std::max(bound, _weights.lines*(lines+second_lines) + _weights.height*remaining);
+    }
+    return bound;
+}
+
+bool AiPolicy::plan(const Game& game)
+{
+    _root=game.grid();
+    _root.remove_piece(game.current());
+    if(!plan(_root, game.current(), game.next())) return false;
+    _planned_piece=game.piece_count();
+    return true;
+}
+
+bool AiPolicy::plan(const Grid& grid, const Piece& current, PieceType next)
+{
+    constexpr double lost=-std::numeric_limits<double>::infinity();
+    auto start=std::chrono::steady_clock::now();
+    _evaluated_grids=0;
+
+    if(&grid!=&_root) _root=grid;
+    const std::vector<Placement>& placements=_first_finder.find(_root, current);
+    if(placements.empty()) return false;
+
+    // One ply : every placement of the current piece.
+    _first_scores.resize(placements.size());
+    _order.resize(placements.size());
+    for(std::size_t index=0; index<placements.size(); ++index)
+    {
+        _first=_root;
+        unsigned int lines;
+        bool is_over=lock(_first, placements[index].piece(), lines);
+        _first_scores[index]= is_over ? lost : evaluate_grid(_first, lines, _weights);
+        _order[index]=index;
+        ++_evaluated_grids;
+    }
+    std::stable_sort(_order.begin(), _order.end(), [this](std::size_t a, std::size_t b){return _first_scores[a]>_first_scores[b];});
+
+    // Two plies, on the threads of the pool. The ranks in _order are dealt in turn to the
+    // shares of the parallel loop, so that every worker starts with one of the most
+    // promising placements and the best score is known early.
+    std::size_t count=_order.size();
+    std::size_t workers=_workers.size();
+    _schedule.resize(count);
+    for(std::size_t rank=0, round=0; rank<count; ++round)
+    {
+        for(std::size_t worker=0; worker<workers && rank<count; ++worker)
+        {
+            if(count*worker/workers+round<count*(worker+1)/workers) _schedule[count*worker/workers+round]=rank++;
+        }
+    }
+    _second_scores.assign(count, lost);
+    _is_deepened.assign(count, 0);
+    std::atomic<double> best_score{lost};
+    std::atomic<bool> is_deepened{false};
+    std::atomic<std::uint64_t> evaluated_grids{0};
+    std::atomic<std::uint64_t> pruned_placements{0};
+    std::atomic<std::uint64_t> cache_hits{0};
+
+    auto deepen=[&](unsigned int worker_index, std::size_t loop_index)
+    {
+        std::size_t index=_order[_schedule[loop_index]];
+        if(_first_scores[index]==lost) return;
+        if(is_deepened.load(std::memory_order_relaxed) && _budget.count()>0 && std::chrono::steady_clock::now()-start>_budget) return;
+
+        Worker& worker=_workers[worker_index];
+        worker.first=_root;
+        unsigned int first_lines;
+        lock(worker.first, placements[index].piece(), first_lines);
+
+        // The score of the rows suppressed by the current piece is added apart, the
+        // stored score only depending on the grid and the pieces.
+        std::uint64_t key=TranspositionTable::key(worker.first.hash(), current.type(), next);
+        double second_score;
+        if(_table.probe(key, second_score))
+        {
+            cache_hits.fetch_add(1, std::memory_order_relaxed);
+        }
+        else
+        {
+            // A placement which can't beat the best one is skipped.
+            if(_can_prune && upper_bound(worker.first, first_lines)<best_score.load(std::memory_order_relaxed))
+            {
+                pruned_placements.fetch_add(1, std::memory_order_relaxed);
+                return;
+            }
+
+            second_score=lost;
+            std::uint64_t grids=0;
+            for(const Placement& second : worker.finder.find(worker.first, next))
+            {
+                worker.second=worker.first;
+                unsigned int second_lines;
+                bool is_over=lock(worker.second, second.piece(), second_lines);
+                ++grids;
+                if(!is_over) second_score=std::max(second_score, evaluate_grid(worker.second, second_lines, _weights));
+            }
+            evaluated_grids.fetch_add(grids, std::memory_order_relaxed);
+            _table.store(key, second_score);
+        }
+        double score= second_score==lost ? lost : second_score+_weights.lines*first_lines;
+        _second_scores[index]=score;
+        _is_deepened[index]=1;
+        is_deepened.store(true, std::memory_order_relaxed);
+        double seen=best_score.load(std::memory_order_relaxed);
+        while(score>seen && !best_score.compare_exchange_weak(seen, score, std::memory_order_relaxed)) {}
+    };
+    if(_pool) _pool->parallel_for(count, deepen);
+    else for(std::size_t index=0; index<count; ++index) deepen(0, index);
+    _evaluated_grids+=evaluated_grids;
+    _pruned_placements=pruned_placements;
+    _cache_hits=cache_hits;
+
+    // The best two-ply score, the first in _order on ties, whatever the thread which found it.
+    std::size_t best=_order.front();
+    double best_found=lost;
+    for(std::size_t index : _order)
+    {
+        if(_is_deepened[index] && _second_scores[index]>best_found)
+        {
+            best_found=_second_scores[index];
+            best=index;
+        }
+    }
+
+    _target=placements[best];
+    _first_finder.path(best, _moves);
+    // The piece is dropped once it is above its placement.
+    while(!_moves.empty() && _moves.back()==Move::down) _moves.pop_back();
+    _moves.push_back(Move::hard_drop);
+    _next_move=0;
+    _expected=current;
+    return true;
+}
+
+Move AiPolicy::choose(const Game& game)
+{
+    // A new piece, or a piece moved by the gravity since the last move : planning again.
+    const Piece& current=game.current();
+    bool is_expected= current.rotation()==_expected.rotation() && current.pivot_row()==_expected.pivot_row()
+                      && current.pivot_col()==_expected.pivot_col();
+    if(game.piece_count()!=_planned_piece || !is_expected || _next_move>=_moves.size())
+    {
+        if(!plan(game)) return Move::none;
+    }
+    Move move=_moves[_next_move++];
+    _expected.move(move);
+    return move;
+}
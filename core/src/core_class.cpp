@@ -9,9 +9,11 @@
 #include <iostream>
 #include <vector>
 #include <string>
-#include <cstdlib> //rand()
+#include <algorithm>
+#include <stdexcept>
 
 #include "core_class.h"
+#include "simd.h"
 
 //////////////////////////////
 ////// Move enum class //////
@@ -73,253 +75,362 @@ void Block::move(Move direction, unsigned int length)
 /////////////////////////
 
 
-Piece::Piece(PieceType ptype, unsigned int pivotRow, unsigned int pivotCol)
-: _type(ptype), _pivot_idx(0)
-{   
-    int color_index= static_cast<int>(ptype);
-    Color color=static_cast<Color>(color_index);
-    Block pivot{pivotRow, pivotCol, color};
-    for(unsigned int i=0; i<4; ++i)
-    {
-        _blocks.push_back(pivot);
-    }
-    // Initialize the blocks relative to the piece type and pivot
-    initializeBlocks();
-}
-
-
-void Piece::initializeBlocks()
+void Piece::move(Move m, unsigned int length)
 {
-    
-    // Set the blocks and pivot index according to the piece type
-    switch(_type)
-    {   
-        case PieceType::I :
-            _blocks[1].move(Move::left,1);
-            _blocks[2].move(Move::left,2);
-            _blocks[3].move(Move::right,1);
+    switch(m)
+    {
+        case Move::clock_rotation :
+            _rotation=(_rotation+1) & 3u;
             break;
-
-        case PieceType::O :
-            _blocks[1].move(Move::left,1);
-            _blocks[2].move(Move::down,1);
-            _blocks[3].move(Move::down,1);
-            _blocks[3].move(Move::left,1);
+        case Move::anticlock_rotation :
+            _rotation=(_rotation+3) & 3u;
             break;
-
-        case PieceType::T :
-            _blocks[1].move(Move::left,1);
-            _blocks[2].move(Move::right,1);
-            _blocks[3].move(Move::down,1);
+        case Move::up :
+            _pivot_row-=length;
             break;
-
-        case PieceType::J :
-            _blocks[1].move(Move::left,1);
-            _blocks[2].move(Move::right,1);
-            _blocks[3].move(Move::down,1);
-            _blocks[3].move(Move::right,1);
+        case Move::down :
+            _pivot_row+=length;
             break;
-
-        case PieceType::L :
-            _blocks[1].move(Move::left,1);
-            _blocks[2].move(Move::right,1);
-            _blocks[3].move(Move::down,1);
-            _blocks[3].move(Move::left,1);
+        case Move::right :
+            _pivot_col+=length;
             break;
-
-        case PieceType::S :
-            _blocks[1].move(Move::right,1);
-            _blocks[2].move(Move::down,1);
-            _blocks[3].move(Move::down,1);
-            _blocks[3].move(Move::left,1);
+        case Move::left :
+            _pivot_col-=length;
             break;
-
-        case PieceType::Z :
-            _blocks[1].move(Move::left,1);
-            _blocks[2].move(Move::down,1);
-            _blocks[3].move(Move::down,1);
-            _blocks[3].move(Move::right,1);
+        default:
             break;
     }
 }
 
-void Piece::move(Move m, unsigned int length)
+////////////////////////
+////// Grid class //////
+////////////////////////
+
+namespace
 {
-    switch(m)
+    // The key of a row, drawn from its index and its occupancy word. It is computed
+    // rather than stored so that the grids of any size share it without a table, and
+    // an empty row has no key so that only the rows which fall have to be rehashed.
+    std::uint64_t row_key(unsigned int row, std::uint64_t cells)
     {
-        case Move::clock_rotation :
-            clock_rotate();
-            break;
-        case Move::anticlock_rotation :
-            anticlock_rotate();
-            break;
-        default:
-            for(Block& block : _blocks){block.move(m, length);}
-            break;
+        return cells==0 ? 0 : mix64(cells+(std::uint64_t{row}+1)*0x9E3779B97F4A7C15ull);
+    }
+
+    // The hash of an empty grid, which sets its size apart.
+    std::uint64_t empty_key(unsigned int nrow, unsigned int ncol)
+    {
+        return mix64(~(std::uint64_t{nrow}<<32 | ncol));
     }
 }
 
+Grid::Grid(unsigned int nrow, unsigned int ncol) 
+: _rows(nrow, 0), _colors(nrow*ncol, Color::none), _row_index(nrow), _ncol{ncol},
+  _heights(ncol, 0), _column_fill(ncol, 0), _lowered_columns{0}, _score{0}, _hash{empty_key(nrow, ncol)}
+{   
+    if(ncol>max_columns)
+    {
+        throw std::invalid_argument("Grid: at most "+std::to_string(max_columns)+" columns are supported");
+    }
+    _full_row= (ncol==max_columns) ? ~std::uint64_t{0} : (std::uint64_t{1}<<ncol)-1;
+    for(unsigned int row=0; row<nrow; ++row) _row_index[row]=row;
+    return;
+} 
 
-void Piece::anticlock_rotate()
+void Grid::fill_cell(unsigned int row, unsigned int column, Color color)
 {
-    if((*this).type()!=PieceType::O)
+    bool was_full= _rows[row]==_full_row;
+    if(((_rows[row]>>column) & 1u)==0)
+    {
+        ++_column_fill[column];
+        _heights[column]=std::max(_heights[column], (*this).column_size()-row);
+        _hash^= row_key(row, _rows[row]) ^ row_key(row, _rows[row] | std::uint64_t{1}<<column);
+        mark_dirty(row, std::uint64_t{1}<<column);
+    }
+    else if(_colors[_row_index[row]*_ncol+column]!=color)
+    {
+        mark_dirty(row, std::uint64_t{1}<<column);
+    }
+    _rows[row]|= std::uint64_t{1}<<column;
+    _colors[_row_index[row]*_ncol+column]=color;
+    if(!was_full && _rows[row]==_full_row)
     {
-        unsigned int pivot_row = _blocks[_pivot_idx].row();    ///< Pivot row
-        unsigned int pivot_col = _blocks[_pivot_idx].column(); ///< Pivot column
+        _full_rows.insert(std::upper_bound(_full_rows.begin(), _full_rows.end(), row), row);
+    }
+}
 
-        for(auto &b : _blocks)
-        {
-            unsigned int relative_row = b.row() - pivot_row; ///< Relative row to pivot
-            unsigned int relative_column = b.column() - pivot_col; ///< Relative column to pivot
-            
-            b.row() = pivot_row -  relative_column; ///< New row after clockwise rotation
-            b.column() = pivot_col +  relative_row; ///< New column after clockwise rotation
-        }
+void Grid::clear_cell(unsigned int row, unsigned int column, bool update_height)
+{
+    if(_rows[row]==_full_row && ((_rows[row]>>column) & 1u)!=0)
+    {
+        _full_rows.erase(std::find(_full_rows.begin(), _full_rows.end(), row));
+    }
+    if(((_rows[row]>>column) & 1u)!=0)
+    {
+        --_column_fill[column];
+        _hash^= row_key(row, _rows[row]) ^ row_key(row, _rows[row] & ~(std::uint64_t{1}<<column));
+        mark_dirty(row, std::uint64_t{1}<<column);
+    }
+    _rows[row]&= ~(std::uint64_t{1}<<column);
+    _colors[_row_index[row]*_ncol+column]=Color::none;
+    if(update_height && (*this).column_size()-row==_heights[column])
+    {
+        lower_height(column);
     }
 }
 
+void Grid::lower_height(unsigned int column)
+{
+    // The stored height is an upper bound : looking for the highest full cell below it.
+    std::size_t row=simd::first_intersecting_row(_rows.data(), (*this).column_size()-_heights[column],
+                                                 (*this).column_size(), std::uint64_t{1}<<column);
+    _heights[column]=(*this).column_size()-static_cast<unsigned int>(row);
+}
 
-void Piece::clock_rotate()
-{   
-    if((*this).type()!=PieceType::O)
+void Grid::move_cells(Piece& piece, Move move, unsigned int length)
+{
+    // The heights of the columns whose top cell is cleared are only lowered by
+    // update(), when the piece is locked : a falling piece doesn't have to scan
+    // the empty rows under it at each move.
+    for(const Block& block : piece.blocks())
     {
-        unsigned int pivot_row = _blocks[_pivot_idx].row();    // Pivot row
-        unsigned int pivot_col = _blocks[_pivot_idx].column(); // Pivot column
-
-        for(auto &b : _blocks)
+        if((*this).column_size()-block.row()==_heights[block.column()])
         {
-            unsigned int relative_row = b.row() - pivot_row; // Relative row to pivot
-            unsigned int relative_column = b.column() - pivot_col; // Relative column to pivot
-
-            b.row() = pivot_row + relative_column; // New row after counterclockwise rotation
-            b.column() = pivot_col - relative_row; // New column after counterclockwise rotation
+            _lowered_columns|= std::uint64_t{1}<<block.column();
         }
+        clear_cell(block.row(), block.column(), false);
+    }
+    piece.move(move, length);
+    for(const Block& block : piece.blocks())
+    {
+        fill_cell(block.row(), block.column(), block.color());
     }
 }
 
-PieceType createRandomPiece()
+bool Grid::locate_shape(const ShapeMask& mask, unsigned int pivot_row, unsigned int pivot_col,
+                        unsigned int& top, unsigned int& left) const
 {
-    PieceType types[] = {
-        PieceType::I,
-        PieceType::O,
-        PieceType::T,
-        PieceType::L,
-        PieceType::J,
-        PieceType::S,
-        PieceType::Z
-    };
+    long long shape_top=static_cast<long long>(pivot_row)+mask.top;
+    long long shape_left=static_cast<long long>(pivot_col)+mask.left;
+    if(shape_top<0 || shape_left<0 || shape_top+mask.height>(*this).column_size() || shape_left+mask.width>_ncol)
+    {
+        return false;
+    }
+    top=static_cast<unsigned int>(shape_top);
+    left=static_cast<unsigned int>(shape_left);
+    return true;
+}
 
-    PieceType randomType = types[rand() % 7];
-    return randomType;
+bool Grid::fits(PieceType type, unsigned int rotation, unsigned int pivot_row, unsigned int pivot_col) const
+{
+    const ShapeMask& mask=shape_masks[static_cast<unsigned int>(type)][rotation];
+    unsigned int top, left;
+    if(!locate_shape(mask, pivot_row, pivot_col, top, left)) return false;
+    // The rows of the mask past the shape are empty : 4 rows are tested when they exist.
+    return !simd::rows_intersect(&_rows[top], mask.rows, std::min(4u, (*this).column_size()-top), left);
 }
 
-////////////////////////
-////// Grid class //////
-////////////////////////
+bool Grid::can_place(const Piece& piece) const
+{
+    return fits(piece.type(), piece.rotation(), piece.pivot_row(), piece.pivot_col());
+}
 
+Piece Grid::put_piece(PieceType ptype, unsigned int pivot)
+{
+    Piece piece {ptype, pivot, (*this).row_size()/2};
+    for(const Block& block : piece.blocks())
+    {   
+        fill_cell(block.row(), block.column(), block.color());
+    }
+    return piece;
+}
 
-Grid::Grid(unsigned int nrow, unsigned int ncol) : _score{0}
-{   
-    std::vector<Cell>  column (ncol);
-    for(unsigned int i=0; i<nrow; ++i)
+void Grid::put_piece(const Piece& piece)
+{
+    for(const Block& block : piece.blocks())
     {
-        matrix.push_back(column);
-    }  
-    return;
-} 
+        fill_cell(block.row(), block.column(), block.color());
+    }
+}
 
-std::vector<unsigned int> Grid::get_full_rows() const 
+void Grid::remove_piece(const Piece& piece)
 {
-    std::vector<unsigned int> full_rows;
-     bool check;
-    for(unsigned int row=0; row<(*this).column_size(); ++row)
-    {   
-        check=true;
-        for(unsigned int column=0; column<(*this).row_size(); ++column)
-        {
-            if(!(*this)(row,column).is_full())
-            {
-                check=false;
-                break;
-            }
-        }
-        if(check)full_rows.push_back(row);
+    for(const Block& block : piece.blocks())
+    {
+        clear_cell(block.row(), block.column());
     }
-    return full_rows;
 }
 
 
-Piece Grid::put_piece(PieceType ptype, unsigned int pivot)
+bool Grid::test_move(const Piece& piece, Move move, unsigned int length) const
 {
-    Piece piece {ptype, pivot, (*this).row_size()/2};
-    for(unsigned int block=0; block<piece.size(); ++block)
-    {   
-        (*this)(piece[block].row(), piece[block].column()).fill(piece[block]);
+    Piece moved=piece;
+    moved.move(move, length);
+    const ShapeMask& mask=shape_masks[static_cast<unsigned int>(moved.type())][moved.rotation()];
+    unsigned int top, left;
+    if(!locate_shape(mask, moved.pivot_row(), moved.pivot_col(), top, left)) return false;
+
+    // A full cell is only an obstacle if it isn't one of the piece's own cells : they
+    // are taken out of the shape before testing it against the rows.
+    std::uint64_t shape[4]={mask.rows[0], mask.rows[1], mask.rows[2], mask.rows[3]};
+    for(const Block& own : piece.blocks())
+    {
+        if(own.row()>=top && own.row()<top+4 && own.column()>=left && own.column()<left+4)
+        {
+            shape[own.row()-top]&= ~(std::uint64_t{1}<<(own.column()-left));
+        }
     }
-    return piece;
+    return !simd::rows_intersect(&_rows[top], shape, std::min(4u, (*this).column_size()-top), left);
 }
 
-
 bool Grid::move_piece(Piece& piece, Move move, unsigned int length)
 {
-    for(unsigned int block=0; block<piece.size(); ++block)
-    {   
-        (*this)(piece[block].row(), piece[block].column()).clear();
+    if(move==Move::hard_drop)
+    {
+        hard_drop(piece);
+        return true;
     }
-    piece.move(move, length);
-    bool is_movable=true;
-    for(unsigned int block=0; block<piece.size(); ++block)
-    { 
-        if(piece[block].row()>=(*this).column_size() || piece[block].column()>=(*this).row_size() 
-            || (*this)(piece[block].row(), piece[block].column()).is_full())
+    if(!test_move(piece, move, length)) return false;
+    move_cells(piece, move, length);
+    return true;
+}
+
+unsigned int Grid::drop_distance(const Piece& piece) const
+{
+    std::array<Block, 4> blocks=piece.blocks();
+    unsigned int distance=(*this).column_size();
+    for(const Block& block : blocks)
+    {
+        // Only the lowest block of each column can meet an obstacle.
+        bool is_lowest=true;
+        for(const Block& other : blocks)
         {
-            is_movable=false;
+            if(other.column()==block.column() && other.row()>block.row()) is_lowest=false;
         }
+        if(!is_lowest) continue;
+
+        unsigned int last_row=std::min(block.row()+1+distance, (*this).column_size());
+        std::size_t row=simd::first_intersecting_row(_rows.data(), block.row()+1, last_row, std::uint64_t{1}<<block.column());
+        distance=std::min(distance, static_cast<unsigned int>(row)-block.row()-1);
     }
-    if(!is_movable)
+    return distance;
+}
+
+unsigned int Grid::hard_drop(Piece& piece)
+{
+    unsigned int distance=drop_distance(piece);
+    if(distance==0) return 0;
+    move_cells(piece, Move::down, distance);
+    return distance;
+}
+
+unsigned int Grid::holes() const
+{
+    unsigned int holes=0;
+    for(unsigned int column=0; column<_ncol; ++column)
     {
-        piece.move(reverse_move(move), length);
+        holes+=column_holes(column);
     }
-    for(unsigned int block=0; block<piece.size(); ++block)
-    {   
-        (*this)(piece[block].row(), piece[block].column()).fill(piece[block]);
-    }
-    return is_movable;
+    return holes;
+}
+
+void Grid::clear_dirty()
+{
+    for(unsigned int row : _dirty.rows) _dirty.cells[row]=0;
+    _dirty.rows.clear();
+}
+
+void Grid::set_dirty_tracking(bool is_tracking)
+{
+    _dirty.cells.clear();
+    _dirty.rows.clear();
+    if(!is_tracking) return;
+    unsigned int nrow=(*this).column_size();
+    _dirty.cells.assign(nrow, 0);
+    _dirty.rows.reserve(nrow);
+    // Nothing has been drawn yet.
+    for(unsigned int row=0; row<nrow; ++row) mark_dirty(row, _full_row);
 }
 
 bool Grid::update()
 {
     // Destroying full rows
    
-    std::vector<unsigned int> full_rows= (*this).get_full_rows();
-    for(unsigned int f_row : full_rows)
+    std::vector<unsigned int>& full_rows= _full_rows;
+
+    for(unsigned int column=0; _lowered_columns!=0; ++column, _lowered_columns>>=1)
+    {
+        if(_lowered_columns & 1u) lower_height(column);
+    }
+
+    // The rows above the lowest full row fall by rotating the row indexes : the
+    // remaining rows keep their colors where they are and the full ones are
+    // recycled as the new empty rows of the top of the grid.
+    unsigned int cleared=full_rows.size();
+    if(cleared>0)
     {
-        for(unsigned int row=f_row; row>=1; --row)
+        // A column whose top cell is above the highest full row keeps it, lowered
+        // by the number of suppressed rows. The top cell of the other columns is
+        // suppressed : their stored height becomes an upper bound to lower.
+        unsigned int highest_full_row=full_rows.front();
+        std::uint64_t lowered_columns=0;
+        for(unsigned int column=0; column<_ncol; ++column)
+        {
+            if((*this).column_size()-_heights[column]==highest_full_row)
+            {
+                lowered_columns|= std::uint64_t{1}<<column;
+            }
+            _heights[column]-=cleared;
+            _column_fill[column]-=cleared;
+        }
+
+        unsigned int write=full_rows.back()+1;
+        for(unsigned int& row : full_rows)
+        {
+            row=_row_index[row];
+        }
+        for(unsigned int row=write; row-->0;)
+        {
+            if(_rows[row]==_full_row)
+            {
+                _hash^=row_key(row, _full_row);
+                continue;
+            }
+            --write;
+            // A fallen row changes of key, and the cells full before or after the fall are redrawn.
+            _hash^= row_key(row, _rows[row]) ^ row_key(write, _rows[row]);
+            mark_dirty(write, _rows[write] | _rows[row]);
+            _rows[write]=_rows[row];
+            _row_index[write]=_row_index[row];
+        }
+        for(unsigned int row=0; row<cleared; ++row)
+        {
+            mark_dirty(row, _rows[row]);
+            _rows[row]=0;
+            _row_index[row]=full_rows[row];
+            std::fill_n(_colors.begin()+full_rows[row]*_ncol, _ncol, Color::none);
+        }
+        full_rows.clear();
+        for(unsigned int column=0; lowered_columns!=0; ++column, lowered_columns>>=1)
         {
-            matrix[row]=matrix[row-1];
+            if(lowered_columns & 1u) lower_height(column);
         }
-        matrix[0]=std::vector<Cell>((*this).row_size());
     }
 
     // Updating the score
 
-    _score= _score + (1+2*(full_rows.size()-1))*(*this).row_size()*full_rows.size();
+    _score= _score + (1+2*(cleared-1))*(*this).row_size()*cleared;
 
 
     // Checking if the game is over.
 
     bool is_game_over=false;
-    for(unsigned int row=0; row<4; ++row)
+    for(unsigned int row=0; row<4 && row<(*this).column_size(); ++row)
     {
-        for(unsigned int column=0; column<(*this).row_size(); ++column)
+        if(_rows[row]!=0)
         {
-            if((*this)(row,column).is_full())
-            {
-                is_game_over=true;
-                break;
-            }
+            is_game_over=true;
+            break;
         }
-        if(is_game_over)break;
     }
     return is_game_over;
 }
@@ -338,3 +449,130 @@ std::string get_grid(Grid grid)
     }
     return grid_as_str;
 }
+
+//////////////////////////////////
+////// PieceGenerator class //////
+//////////////////////////////////
+
+PieceGenerator::PieceGenerator(std::uint64_t seed, GeneratorPolicy policy,
+                               unsigned int history_size, unsigned int history_tries)
+: _policy{policy}, _history_size{history_size}, _history_tries{history_tries}
+{
+    if(history_size>max_history)
+    {
+        throw std::invalid_argument("PieceGenerator: the history holds at most "+std::to_string(max_history)+" pieces");
+    }
+    _queue.reserve(2*block_size);
+    reset(seed);
+}
+
+void PieceGenerator::reset(std::uint64_t seed)
+{
+    _seed=seed;
+    // The state is expanded from the seed with splitmix64, as advised for xoshiro.
+    std::uint64_t z=seed;
+    for(std::uint64_t& word : _state)
+    {
+        z+=0x9E3779B97F4A7C15ull;
+        word=mix64(z);
+    }
+    _bag_position=7;
+    // The history starts full of Z pieces, so that the first piece is rarely a Z.
+    _history.fill(PieceType::Z);
+    _history_position=0;
+    _queue.clear();
+    _queue_position=0;
+}
+
+std::uint64_t PieceGenerator::random()
+{
+    auto rotl=[](std::uint64_t x, int k){return (x<<k) | (x>>(64-k));};
+    std::uint64_t result=rotl(_state[1]*5, 7)*9;
+    std::uint64_t t=_state[1]<<17;
+    _state[2]^=_state[0];
+    _state[3]^=_state[1];
+    _state[1]^=_state[2];
+    _state[0]^=_state[3];
+    _state[2]^=t;
+    _state[3]=rotl(_state[3], 45);
+    return result;
+}
+
+unsigned int PieceGenerator::bounded(unsigned int range)
+{
+    std::uint64_t product=(random()>>32)*range;
+    std::uint32_t low=static_cast<std::uint32_t>(product);
+    if(low<range)
+    {
+        std::uint32_t threshold=static_cast<std::uint32_t>(-range)%range;
+        while(low<threshold)
+        {
+            product=(random()>>32)*range;
+            low=static_cast<std::uint32_t>(product);
+        }
+    }
+    return static_cast<unsigned int>(product>>32);
+}
+
+PieceType PieceGenerator::generate()
+{
+    switch(_policy)
+    {
+        case GeneratorPolicy::bag :
+            if(_bag_position==7)
+            {
+                for(unsigned int type=0; type<7; ++type) _bag[type]=static_cast<PieceType>(type);
+                for(unsigned int i=6; i>0; --i) std::swap(_bag[i], _bag[bounded(i+1)]);
+                _bag_position=0;
+            }
+            return _bag[_bag_position++];
+
+        case GeneratorPolicy::history :
+        {
+            PieceType type=static_cast<PieceType>(bounded(7));
+            for(unsigned int tries=1; tries<_history_tries; ++tries)
+            {
+                bool in_history=false;
+                for(unsigned int i=0; i<_history_size; ++i)
+                {
+                    if(_history[i]==type) in_history=true;
+                }
+                if(!in_history) break;
+                type=static_cast<PieceType>(bounded(7));
+            }
+            if(_history_size>0)
+            {
+                _history[_history_position]=type;
+                _history_position=(_history_position+1)%_history_size;
+            }
+            return type;
+        }
+
+        default :
+            return static_cast<PieceType>(bounded(7));
+    }
+}
+
+void PieceGenerator::refill()
+{
+    _queue.erase(_queue.begin(), _queue.begin()+_queue_position);
+    _queue_position=0;
+    for(unsigned int i=0; i<block_size; ++i) _queue.push_back(generate());
+}
+
+PieceType PieceGenerator::next()
+{
+    if(_queue_position==_queue.size()) refill();
+    return _queue[_queue_position++];
+}
+
+PieceType PieceGenerator::peek(std::size_t ahead)
+{
+    while(_queue_position+ahead>=_queue.size()) refill();
+    return _queue[_queue_position+ahead];
+}
+
+void PieceGenerator::fill(PieceType* pieces, std::size_t count)
+{
+    for(std::size_t i=0; i<count; ++i) pieces[i]=next();
+}
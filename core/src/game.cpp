@@ -0,0 +1,124 @@
+/**
+ * \file game.cpp
+ * \brief This file contains the definitions of the Game class methods.
+ * \author Alexandre Bleuler - Bonaventure Dohemeto
+ * \version 2.0
+ * \date 18/10/2026
+ */
+
+#include <cmath>
+
+#include "game.h"
+
+Game::Game(unsigned int nrow, unsigned int ncol, std::uint64_t seed, unsigned int ticks_per_second,
+           GeneratorPolicy policy)
+: _grid{nrow, ncol}, _generator{seed, policy}, _ticks_per_second{ticks_per_second}
+{
+    reset(seed);
+}
+
+void Game::reset(std::uint64_t seed)
+{
+    bool is_tracking_dirty=_grid.is_tracking_dirty();
+    _grid=Grid(_grid.column_size(), _grid.row_size());
+    _grid.set_dirty_tracking(is_tracking_dirty);
+    _generator.reset(seed);
+    _ticks=0;
+    _pieces=0;
+    _gravity_ticks=0;
+    _time_decrease_rate=0;
+    _score_threshold=200;
+    _level=0;
+    _is_over=false;
+    _events.clear();
+    _recorded_moves.clear();
+    _current=_grid.put_piece(_generator.next());
+    _next=_generator.next();
+}
+
+unsigned int Game::gravity_interval() const
+{
+    // The gravity step of the original game happened each (1 - rate) * 0.6 seconds.
+    double interval= std::round((1-_time_decrease_rate)*0.6*_ticks_per_second);
+    return interval<1 ? 1 : static_cast<unsigned int>(interval);
+}
+
+bool Game::input(Move move)
+{
+    if(_is_over || move==Move::up || move==Move::none) return false;
+    if(!_grid.move_piece(_current, move)) return false;
+    if(_is_recording) _recorded_moves.push_back(TimedMove{_ticks, move});
+    if(move==Move::hard_drop)
+    {
+        _gravity_ticks=0;
+        lock();
+    }
+    return true;
+}
+
+void Game::tick()
+{
+    if(_is_over) return;
+    ++_ticks;
+    if(++_gravity_ticks<gravity_interval()) return;
+    _gravity_ticks=0;
+    if(!_grid.move_piece(_current, Move::down))
+    {
+        lock();
+    }
+}
+
+void Game::advance(std::uint64_t ticks)
+{
+    while(ticks>0 && !_is_over)
+    {
+        // Every tick before the next gravity step only increments the counters.
+        unsigned int interval=gravity_interval();
+        std::uint64_t idle= _gravity_ticks+1<interval ? interval-_gravity_ticks-1 : 0;
+        if(ticks<=idle)
+        {
+            _ticks+=ticks;
+            _gravity_ticks+=static_cast<unsigned int>(ticks);
+            return;
+        }
+        _ticks+=idle;
+        _gravity_ticks+=static_cast<unsigned int>(idle);
+        ticks-=idle+1;
+        tick();
+    }
+}
+
+void Game::lock()
+{
+    ++_pieces;
+    _events.push_back(GameEvent::piece_locked);
+
+    unsigned int previous_score=_grid.score();
+    _is_over=_grid.update();
+    if(_grid.score()>previous_score)
+    {
+        _events.push_back(GameEvent::lines_cleared);
+    }
+
+    if(_is_over)
+    {
+        _events.push_back(GameEvent::game_over);
+        return;
+    }
+    if(_grid.score()>_score_threshold)
+    {
+        _score_threshold*=2.25;
+        _time_decrease_rate+=0.05;
+        ++_level;
+        _events.push_back(GameEvent::level_up);
+    }
+    _current=_grid.put_piece(_next);
+    _next=_generator.next();
+}
+
+void Game::preview(PieceType* pieces, std::size_t count)
+{
+    if(count==0) return;
+    pieces[0]=_next;
+    for(std::size_t i=1; i<count; ++i) pieces[i]=_generator.peek(i-1);
+}
@@ -0,0 +1,195 @@
+/**
+ * \file parallel.cpp
+ * \brief This file contains the definition of the work-stealing parallel loop.
+ * \author Alexandre Bleuler - Bonaventure Dohemeto
+ * \version 2.0
+ * \date 18/10/2026
+ */
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <thread>
+#include <vector>
+
+#include "parallel.h"
+
+/**
+ * \brief The share of indexes [begin, end) of a worker, packed in one word
+ * (begin in the high half, end in the low half) so that it can be updated with
+ * a single compare-and-swap. Each share sits on its own cache line.
+ */
+
+struct alignas(64) ThreadPool::Share
+{
+    std::atomic<std::uint64_t> range{0};
+};
+
+namespace
+{
+    using Share=ThreadPool::Share;
+
+    std::uint64_t pack(std::uint64_t begin, std::uint64_t end) {return (begin<<32) | end;}
+    std::uint64_t begin_of(std::uint64_t range) {return range>>32;}
+    std::uint64_t end_of(std::uint64_t range) {return range & 0xFFFFFFFFull;}
+
+    // Takes the first index of a share. The owner takes indexes from the front.
+    bool pop_front(Share& share, std::size_t& index)
+    {
+        std::uint64_t range=share.range.load(std::memory_order_relaxed);
+        while(begin_of(range)<end_of(range))
+        {
+            if(share.range.compare_exchange_weak(range, pack(begin_of(range)+1, end_of(range)), std::memory_order_acq_rel))
+            {
+                index=begin_of(range);
+                return true;
+            }
+        }
+        return false;
+    }
+
+    // Takes the back half of a share. Thieves take indexes from the back.
+    bool steal_back(Share& share, std::uint64_t& begin, std::uint64_t& end)
+    {
+        std::uint64_t range=share.range.load(std::memory_order_relaxed);
+        while(begin_of(range)<end_of(range))
+        {
+            std::uint64_t middle=begin_of(range)+(end_of(range)-begin_of(range))/2;
+            if(share.range.compare_exchange_weak(range, pack(begin_of(range), middle), std::memory_order_acq_rel))
+            {
+                begin=middle;
+                end=end_of(range);
+                return true;
+            }
+        }
+        return false;
+    }
+
+    // Gives each worker a contiguous share of the indexes.
+    void split(Share* shares, unsigned int threads, std::size_t count)
+    {
+        for(unsigned int worker=0; worker<threads; ++worker)
+        {
+            shares[worker].range.store(pack(count*worker/threads, count*(worker+1)/threads));
+        }
+    }
+
+    // Processes the own share of a worker, then steals from the others until every share is empty.
+    void run_worker(Share* shares, unsigned int threads, unsigned int worker,
+                    const std::function<void(unsigned int worker, std::size_t index)>& body)
+    {
+        Share& own=shares[worker];
+        std::size_t index;
+        while(true)
+        {
+            while(pop_front(own, index)) body(worker, index);
+
+            // The own share is empty : looking for a victim, starting with the next worker.
+            bool has_stolen=false;
+            for(unsigned int offset=1; offset<threads && !has_stolen; ++offset)
+            {
+                std::uint64_t begin, end;
+                if(steal_back(shares[(worker+offset)%threads], begin, end))
+                {
+                    own.range.store(pack(begin, end), std::memory_order_release);
+                    has_stolen=true;
+                }
+            }
+            if(!has_stolen) return;
+        }
+    }
+}
+
+unsigned int thread_count(unsigned int threads)
+{
+    if(threads==0) threads=std::thread::hardware_concurrency();
+    return threads==0 ? 1 : threads;
+}
+
+void parallel_for(std::size_t count, unsigned int threads,
+                  const std::function<void(unsigned int worker, std::size_t index)>& body)
+{
+    threads=thread_count(threads);
+    if(threads>count) threads=count==0 ? 1 : static_cast<unsigned int>(count);
+    if(threads==1)
+    {
+        for(std::size_t index=0; index<count; ++index) body(0, index);
+        return;
+    }
+
+    std::unique_ptr<Share[]> shares{new Share[threads]};
+    split(shares.get(), threads, count);
+    std::vector<std::thread> workers;
+    workers.reserve(threads-1);
+    for(unsigned int worker=1; worker<threads; ++worker)
+    {
+        workers.emplace_back(run_worker, shares.get(), threads, worker, std::cref(body));
+    }
+    run_worker(shares.get(), threads, 0, body);
+    for(std::thread& thread : workers) thread.join();
+}
+
+//////////////////////////////
+////// ThreadPool class //////
+//////////////////////////////
+
+ThreadPool::ThreadPool(unsigned int threads)
+: _size{thread_count(threads)}, _shares{new Share[_size]}
+{
+    _threads.reserve(_size-1);
+    for(unsigned int worker=1; worker<_size; ++worker)
+    {
+        _threads.emplace_back(&ThreadPool::work, this, worker);
+    }
+}
+
+ThreadPool::~ThreadPool()
+{
+    {
+        std::lock_guard<std::mutex> lock{_mutex};
+        _is_stopping=true;
+    }
+    _start.notify_all();
+    for(std::thread& thread : _threads) thread.join();
+}
+
+void ThreadPool::work(unsigned int worker)
+{
+    std::uint64_t done_loops=0;
+    while(true)
+    {
+        const std::function<void(unsigned int, std::size_t)>* body;
+        {
+            std::unique_lock<std::mutex> lock{_mutex};
+            _start.wait(lock, [&]{return _is_stopping || _loop!=done_loops;});
+            if(_is_stopping) return;
+            done_loops=_loop;
+            body=_body;
+        }
+        run_worker(_shares.get(), _size, worker, *body);
+        {
+            std::lock_guard<std::mutex> lock{_mutex};
+            if(--_running==0) _done.notify_one();
+        }
+    }
+}
+
+void ThreadPool::parallel_for(std::size_t count, const std::function<void(unsigned int worker, std::size_t index)>& body)
+{
+    if(_size==1 || count<=1)
+    {
+        for(std::size_t index=0; index<count; ++index) body(0, index);
+        return;
+    }
+    split(_shares.get(), _size, count);
+    {
+        std::lock_guard<std::mutex> lock{_mutex};
+        _body=&body;
+        _running=_size-1;
+        ++_loop;
+    }
+    _start.notify_all();
+    run_worker(_shares.get(), _size, 0, body);
+    std::unique_lock<std::mutex> lock{_mutex};
+    _done.wait(lock, [this]{return _running==0;});
+}
@@ -0,0 +1,167 @@
+/**
+ * \file placement.cpp
+ * \brief This file contains the definitions of the PlacementFinder class methods.
+ * \author Alexandre Bleuler - Bonaventure Dohemeto
+ * \version 2.0
+ * \date 18/10/2026
+ */
+
+#include <algorithm>
+#include <array>
+
+#include "placement.h"
+
+namespace
+{
+    /**
+     * \brief For a rotation state of a piece, the first rotation state covering the
+     * same cells once translated, and the translation of the pivot between both.
+     */
+
+    struct Symmetry
+    {
+        unsigned int rotation; /**< The first rotation state with the same cells. */
+        int row_shift; /**< The shift of the pivot's row to get the same cells in that state. */
+        int column_shift; /**< The shift of the pivot's column to get the same cells in that state. */
+    };
+
+    using SymmetryTable=std::array<std::array<Symmetry, 4>, 7>;
+
+    SymmetryTable make_symmetries()
+    {
+        SymmetryTable table{};
+        for(unsigned int type=0; type<7; ++type)
+        {
+            // The cells of each state, relatively to their top left corner.
+            std::array<std::array<int, 4>, 4> keys;
+            std::array<int, 4> min_rows, min_columns;
+            for(unsigned int rotation=0; rotation<4; ++rotation)
+            {
+                const BlockOffset* offsets=piece_shapes[type][rotation];
+                int min_row=offsets[0].row, min_column=offsets[0].column;
+                for(unsigned int i=1; i<4; ++i)
+                {
+                    min_row=std::min(min_row, offsets[i].row);
+                    min_column=std::min(min_column, offsets[i].column);
+                }
+                for(unsigned int i=0; i<4; ++i)
+                {
+                    keys[rotation][i]=(offsets[i].row-min_row)*4+offsets[i].column-min_column;
+                }
+                std::sort(keys[rotation].begin(), keys[rotation].end());
+                min_rows[rotation]=min_row;
+                min_columns[rotation]=min_column;
+
+                unsigned int first=0;
+                while(keys[first]!=keys[rotation]) ++first;
+                table[type][rotation]=Symmetry{first, min_rows[rotation]-min_rows[first], min_columns[rotation]-min_columns[first]};
+            }
+        }
+        return table;
+    }
+
+    const SymmetryTable symmetries=make_symmetries();
+
+    constexpr Move moves[]={Move::left, Move::right, Move::down, Move::clock_rotation, Move::anticlock_rotation};
+}
+
+void PlacementFinder::prepare(const Grid& grid)
+{
+    _nrow=grid.column_size();
+    _ncol=grid.row_size();
+    std::size_t states=4*static_cast<std::size_t>(_nrow)*_ncol;
+    if(_visited.size()<states)
+    {
+        _visited.assign(states, 0);
+        _locked.assign(states, 0);
+        _parent.resize(states);
+        _parent_move.resize(states);
+        _queue.reserve(states);
+        _generation=0;
+    }
+    if(++_generation==0)
+    {
+        std::fill(_visited.begin(), _visited.end(), 0);
+        std::fill(_locked.begin(), _locked.end(), 0);
+        _generation=1;
+    }
+    _queue.clear();
+    _placements.clear();
+    _placement_states.clear();
+}
+
+const std::vector<Placement>& PlacementFinder::find(const Grid& grid, PieceType type)
+{
+    return find(grid, Piece{type, 0, grid.row_size()/2});
+}
+
+const std::vector<Placement>& PlacementFinder::find(const Grid& grid, const Piece& start)
+{
+    prepare(grid);
+    if(!grid.can_place(start)) return _placements;
+
+    std::uint32_t start_state=state(start.rotation(), start.pivot_row(), start.pivot_col());
+    _visited[start_state]=_generation;
+    _parent[start_state]=start_state;
+    _queue.push_back(start_state);
+    const std::array<Symmetry, 4>& symmetry=symmetries[static_cast<unsigned int>(start.type())];
+
+    // The collisions are checked on the occupancy words of the rows, with the masks of
+    // the shapes (see Grid::fits) : no Piece has to be built for each state.
+    PieceType type=start.type();
+    auto is_free=[&grid, type](unsigned int rotation, unsigned int row, unsigned int column)
+    {
+        return grid.fits(type, rotation, row, column);
+    };
+
+    for(std::size_t next=0; next<_queue.size(); ++next)
+    {
+        std::uint32_t current=_queue[next];
+        unsigned int column=current%_ncol;
+        unsigned int row=(current/_ncol)%_nrow;
+        unsigned int rotation=current/_ncol/_nrow;
+
+        // The states reached by left, right, down, clockwise and anticlockwise moves.
+        const unsigned int rotations[5]={rotation, rotation, rotation, (rotation+1)&3u, (rotation+3)&3u};
+        const unsigned int rows[5]={row, row, row+1, row, row};
+        const unsigned int columns[5]={column-1, column+1, column, column, column};
+        for(unsigned int i=0; i<5; ++i)
+        {
+            if(is_free(rotations[i], rows[i], columns[i]))
+            {
+                std::uint32_t reached=state(rotations[i], rows[i], columns[i]);
+                if(_visited[reached]!=_generation)
+                {
+                    _visited[reached]=_generation;
+                    _parent[reached]=current;
+                    _parent_move[reached]=moves[i];
+                    _queue.push_back(reached);
+                }
+            }
+            else if(moves[i]==Move::down)
+            {
+                // The piece can't go down : it is a placement, unless a piece covering
+                // the same cells was already locked.
+                const Symmetry& same=symmetry[rotation];
+                std::uint32_t canonical=state(same.rotation, row+same.row_shift, column+same.column_shift);
+                if(_locked[canonical]!=_generation)
+                {
+                    _locked[canonical]=_generation;
+                    _placements.push_back(Placement{start.type(), rotation, row, column});
+                    _placement_states.push_back(current);
+                }
+            }
+        }
+    }
+    return _placements;
+}
+
+void PlacementFinder::path(std::size_t index, std::vector<Move>& moves) const
+{
+    moves.clear();
+    for(std::uint32_t current=_placement_states[index]; _parent[current]!=current; current=_parent[current])
+    {
+        moves.push_back(_parent_move[current]);
+    }
+    std::reverse(moves.begin(), moves.end());
+}
@@ -0,0 +1,164 @@
+/**
+ * \file replay.cpp
+ * \brief This file contains the definitions of the functions recording, storing
+ * and playing back replays.
+ * \author Alexandre Bleuler - Bonaventure Dohemeto
+ * \version 2.0
+ * \date 18/10/2026
+ */
+
+#include <algorithm>
+#include <fstream>
+
+#include "replay.h"
+
+namespace
+{
+    const char magic[4]={'T', 'R', 'P', 'L'};
+    const unsigned char version=1;
+
+    // Unsigned LEB128 : 7 bits per byte, the high bit announcing another byte.
+    void write_varint(std::ostream& out, std::uint64_t value)
+    {
+        while(value>=0x80)
+        {
+            out.put(static_cast<char>((value & 0x7F) | 0x80));
+            value>>=7;
+        }
+        out.put(static_cast<char>(value));
+    }
+
+    bool read_varint(std::istream& in, std::uint64_t& value)
+    {
+        value=0;
+        for(unsigned int shift=0; shift<64; shift+=7)
+        {
+            int byte=in.get();
+            if(byte==std::char_traits<char>::eof()) return false;
+            value|=static_cast<std::uint64_t>(byte & 0x7F)<<shift;
+            if(!(byte & 0x80)) return true;
+        }
+        return false;
+    }
+
+    bool read_unsigned(std::istream& in, unsigned int& value, std::uint64_t min, std::uint64_t max)
+    {
+        std::uint64_t read;
+        if(!read_varint(in, read) || read<min || read>max) return false;
+        value=static_cast<unsigned int>(read);
+        return true;
+    }
+}
+
+Replay make_replay(const Game& game)
+{
+    Replay replay;
+    replay.seed=game.seed();
+    replay.generator=game.generator_policy();
+    replay.rows=game.grid().column_size();
+    replay.columns=game.grid().row_size();
+    replay.ticks_per_second=game.ticks_per_second();
+    replay.moves=game.recorded_moves();
+    replay.ticks=game.tick_count();
+    replay.score=game.score();
+    return replay;
+}
+
+void write_replay(std::ostream& out, const Replay& replay)
+{
+    out.write(magic, sizeof(magic));
+    out.put(static_cast<char>(version));
+    out.put(static_cast<char>(replay.generator));
+    for(unsigned int byte=0; byte<8; ++byte) out.put(static_cast<char>(replay.seed>>(8*byte)));
+    write_varint(out, replay.rows);
+    write_varint(out, replay.columns);
+    write_varint(out, replay.ticks_per_second);
+    write_varint(out, replay.moves.size());
+    std::uint64_t tick=0;
+    for(const TimedMove& move : replay.moves)
+    {
+        write_varint(out, move.tick-tick);
+        out.put(static_cast<char>(move.move));
+        tick=move.tick;
+    }
+    write_varint(out, replay.ticks);
+    write_varint(out, replay.score);
+}
+
+bool read_replay(std::istream& in, Replay& replay)
+{
+    char header[6];
+    if(!in.read(header, sizeof(header))) return false;
+    if(!std::equal(magic, magic+sizeof(magic), header) || static_cast<unsigned char>(header[4])!=version) return false;
+    if(static_cast<unsigned char>(header[5])>static_cast<unsigned char>(GeneratorPolicy::history)) return false;
+    replay.generator=static_cast<GeneratorPolicy>(header[5]);
+
+    replay.seed=0;
+    for(unsigned int byte=0; byte<8; ++byte)
+    {
+        int value=in.get();
+        if(value==std::char_traits<char>::eof()) return false;
+        replay.seed|=static_cast<std::uint64_t>(value)<<(8*byte);
+    }
+    // The same limits as the ones of the simulations.
+    if(!read_unsigned(in, replay.rows, 5, 1u<<16)) return false;
+    if(!read_unsigned(in, replay.columns, 4, Grid::max_columns)) return false;
+    if(!read_unsigned(in, replay.ticks_per_second, 1, 1u<<16)) return false;
+
+    std::uint64_t count;
+    if(!read_varint(in, count)) return false;
+    replay.moves.clear();
+    std::uint64_t tick=0;
+    for(std::uint64_t i=0; i<count; ++i)
+    {
+        std::uint64_t delta;
+        if(!read_varint(in, delta)) return false;
+        int move=in.get();
+        if(move==std::char_traits<char>::eof() || move==static_cast<int>(Move::up) || move>=static_cast<int>(Move::none)) return false;
+        tick+=delta;
+        replay.moves.push_back(TimedMove{tick, static_cast<Move>(move)});
+    }
+    if(!read_varint(in, replay.ticks) || replay.ticks<tick) return false;
+    std::uint64_t score;
+    if(!read_varint(in, score) || score>0xFFFFFFFFull) return false;
+    replay.score=static_cast<unsigned int>(score);
+    return true;
+}
+
+bool save_replay(const std::string& path, const Replay& replay)
+{
+    std::ofstream file(path, std::ios::binary);
+    if(!file) return false;
+    write_replay(file, replay);
+    return static_cast<bool>(file);
+}
+
+bool load_replay(const std::string& path, Replay& replay)
+{
+    std::ifstream file(path, std::ios::binary);
+    if(!file) return false;
+    return read_replay(file, replay);
+}
+
+PlaybackResult play_replay(const Replay& replay)
+{
+    Game game{replay.rows, replay.columns, replay.seed, replay.ticks_per_second, replay.generator};
+    PlaybackResult result;
+    bool are_moves_valid=true;
+    for(const TimedMove& move : replay.moves)
+    {
+        if(move.tick<game.tick_count()) are_moves_valid=false;
+        else game.advance(move.tick-game.tick_count());
+        game.clear_events();
+        if(!game.input(move.move)) are_moves_valid=false;
+        if(!are_moves_valid) break;
+    }
+    if(are_moves_valid && replay.ticks>=game.tick_count()) game.advance(replay.ticks-game.tick_count());
+
+    result.score=game.score();
+    result.ticks=game.tick_count();
+    result.pieces=game.piece_count();
+    result.is_over=game.is_over();
+    result.is_valid= are_moves_valid && result.ticks==replay.ticks && result.score==replay.score;
+    return result;
+}
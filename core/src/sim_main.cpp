@@ -0,0 +1,125 @@
+/**
+ * \file sim_main.cpp
+ * \brief Headless batch simulation executable (tetris_sim)
+ * \author Alexandre Bleuler - Bonaventure Dohemeto
+ * \version 2.0
+ * \date 18/10/2026
+ */
+
+#include <chrono>
+#include <iostream>
+#include <string>
+#include "parallel.h"
+#include "replay.h"
+#include "simd.h"
+#include "simulation.h"
+
+// Plays a replay file back and checks its score
+int play_replay_file(const std::string& path)
+{
+    Replay replay;
+    if(!load_replay(path, replay))
+    {
+        std::cerr<<"Invalid replay "<<path<<'\n';
+        return 1;
+    }
+    auto start=std::chrono::steady_clock::now();
+    PlaybackResult result=play_replay(replay);
+    double seconds=std::chrono::duration<double>(std::chrono::steady_clock::now()-start).count();
+    std::cout<<"replay      : "<<path<<'\n';
+    std::cout<<"grid        : "<<replay.rows<<" x "<<replay.columns<<'\n';
+    std::cout<<"seed        : "<<replay.seed<<'\n';
+    std::cout<<"moves       : "<<replay.moves.size()<<'\n';
+    std::cout<<"ticks       : "<<result.ticks<<" (recorded "<<replay.ticks<<")\n";
+    std::cout<<"score       : "<<result.score<<" (recorded "<<replay.score<<")\n";
+    std::cout<<"duration    : "<<seconds<<" s\n";
+    std::cout<<"valid       : "<<(result.is_valid ? "yes" : "no")<<'\n';
+    return result.is_valid ? 0 : 2;
+}
+
+// Prints the options of the executable
+void print_usage()
+{
+    std::cerr<<"Usage : tetris_sim [--games N] [--seed S] [--rows R] [--columns C]\n"
+             <<"                  [--ticks-per-second F] [--max-ticks T] [--policy idle|random|ai]\n"
+             <<"                  [--generator uniform|bag|history] [--threads N (0 for one per core)]\n"
+             <<"       tetris_sim --replay FILE\n";
+}
+
+int main(int argc, char* argv[])
+{
+    SimulationConfig config;
+    std::string generator_name="uniform";
+
+    // Parsing the options, each of them being followed by its value.
+    for(int i=1; i<argc; ++i)
+    {
+        std::string option=argv[i];
+        if(option=="--help" || option=="-h")
+        {
+            print_usage();
+            return 0;
+        }
+        if(i+1>=argc)
+        {
+            std::cerr<<"Missing value for "<<option<<'\n';
+            print_usage();
+            return 1;
+        }
+        std::string value=argv[++i];
+        try
+        {
+            if(option=="--games") config.games=std::stoul(value);
+            else if(option=="--seed") config.seed=std::stoull(value);
+            else if(option=="--rows") config.rows=std::stoul(value);
+            else if(option=="--columns") config.columns=std::stoul(value);
+            else if(option=="--ticks-per-second") config.ticks_per_second=std::stoul(value);
+            else if(option=="--max-ticks") config.max_ticks=std::stoull(value);
+            else if(option=="--policy") config.policy=value;
+            else if(option=="--generator")
+            {
+                generator_name=value;
+                if(!generator_policy_from_name(value, config.generator))
+                {
+                    std::cerr<<"Unknown generator "<<value<<'\n';
+                    return 1;
+                }
+            }
+            else if(option=="--replay") return play_replay_file(value);
+            else if(option=="--threads") config.threads=std::stoul(value);
+            else
+            {
+                std::cerr<<"Unknown option "<<option<<'\n';
+                print_usage();
+                return 1;
+            }
+        }
+        catch(const std::exception&)
+        {
+            std::cerr<<"Invalid value "<<value<<" for "<<option<<'\n';
+            return 1;
+        }
+    }
+
+    if(!make_policy(config.policy))
+    {
+        std::cerr<<"Unknown policy "<<config.policy<<'\n';
+        return 1;
+    }
+    if(config.rows<5 || config.columns<4 || config.columns>Grid::max_columns || config.ticks_per_second==0)
+    {
+        std::cerr<<"The grid needs at least 5 rows and 4 to "<<Grid::max_columns<<" columns, "
+                 <<"and the gravity at least one tick per second\n";
+        return 1;
+    }
+
+    SimulationResult result=run_simulation(config);
+    std::cout<<"policy      : "<<config.policy<<'\n';
+    std::cout<<"generator   : "<<generator_name<<'\n';
+    std::cout<<"grid        : "<<config.rows<<" x "<<config.columns<<'\n';
+    std::cout<<"seed        : "<<config.seed<<'\n';
+    std::cout<<"threads     : "<<thread_count(config.threads)<<'\n';
+    std::cout<<"kernels     : "<<simd::level_name(simd::level())<<'\n';
+    print_report(std::cout, result);
+    return 0;
+}
@@ -0,0 +1,170 @@
+/**
+ * \file simd.cpp
+ * \brief This file contains the scalar and vector implementations of the kernels
+ * on occupancy words and their selection at runtime.
+ * \author Alexandre Bleuler - Bonaventure Dohemeto
+ * \version 2.0
+ * \date 18/10/2026
+ */
+
+#include "simd.h"
+
+// The vector kernels are compiled for their own instruction set with the target
+// attribute of GCC and Clang, so the rest of the project doesn't need any flag.
+#if (defined(__x86_64__) || defined(__i386__)) && (defined(__GNUC__) || defined(__clang__))
+#define SIMD_X86 1
+#include <immintrin.h>
+#endif
+
+namespace
+{
+    ////// Scalar kernels //////
+
+    std::size_t first_intersecting_row_scalar(const std::uint64_t* rows, std::size_t begin, std::size_t end, std::uint64_t mask)
+    {
+        while(begin<end && (rows[begin] & mask)==0) ++begin;
+        return begin;
+    }
+
+    bool rows_intersect_scalar(const std::uint64_t* rows, const std::uint64_t* masks, unsigned int count, unsigned int shift)
+    {
+        for(unsigned int row=0; row<count; ++row)
+        {
+            if(rows[row] & (masks[row]<<shift)) return true;
+        }
+        return false;
+    }
+
+#ifdef SIMD_X86
+
+    ////// SSE4.1 kernels //////
+
+    __attribute__((target("sse4.1")))
+    std::size_t first_intersecting_row_sse41(const std::uint64_t* rows, std::size_t begin, std::size_t end, std::uint64_t mask)
+    {
+        __m128i masks=_mm_set1_epi64x(static_cast<long long>(mask));
+        for(; begin+2<=end; begin+=2)
+        {
+            __m128i words=_mm_loadu_si128(reinterpret_cast<const __m128i*>(rows+begin));
+            if(!_mm_testz_si128(words, masks)) break;
+        }
+        return first_intersecting_row_scalar(rows, begin, end, mask);
+    }
+
+    __attribute__((target("sse4.1")))
+    bool rows_intersect_sse41(const std::uint64_t* rows, const std::uint64_t* masks, unsigned int count, unsigned int shift)
+    {
+        __m128i count_shift=_mm_cvtsi32_si128(static_cast<int>(shift));
+        unsigned int row=0;
+        for(; row+2<=count; row+=2)
+        {
+            __m128i words=_mm_loadu_si128(reinterpret_cast<const __m128i*>(rows+row));
+            __m128i shape=_mm_sll_epi64(_mm_loadu_si128(reinterpret_cast<const __m128i*>(masks+row)), count_shift);
+            if(!_mm_testz_si128(words, shape)) return true;
+        }
+        return row<count && (rows[row] & (masks[row]<<shift))!=0;
+    }
+
+    ////// AVX2 kernels //////
+
+    __attribute__((target("avx2")))
+    std::size_t first_intersecting_row_avx2(const std::uint64_t* rows, std::size_t begin, std::size_t end, std::uint64_t mask)
+    {
+        __m256i masks=_mm256_set1_epi64x(static_cast<long long>(mask));
+        for(; begin+4<=end; begin+=4)
+        {
+            __m256i words=_mm256_loadu_si256(reinterpret_cast<const __m256i*>(rows+begin));
+            if(!_mm256_testz_si256(words, masks)) break;
+        }
+        return first_intersecting_row_scalar(rows, begin, end, mask);
+    }
+
+    __attribute__((target("avx2")))
+    bool rows_intersect_avx2(const std::uint64_t* rows, const std::uint64_t* masks, unsigned int count, unsigned int shift)
+    {
+        if(count<4) return rows_intersect_scalar(rows, masks, count, shift);
+        __m256i words=_mm256_loadu_si256(reinterpret_cast<const __m256i*>(rows));
+        __m256i shape=_mm256_sll_epi64(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(masks)),
+                                       _mm_cvtsi32_si128(static_cast<int>(shift)));
+        return !_mm256_testz_si256(words, shape);
+    }
+
+#endif
+
+    ////// Selection //////
+
+    struct Kernels
+    {
+        simd::Level level;
+        std::size_t (*first_intersecting_row)(const std::uint64_t*, std::size_t, std::size_t, std::uint64_t);
+        bool (*rows_intersect)(const std::uint64_t*, const std::uint64_t*, unsigned int, unsigned int);
+    };
+
+    Kernels kernels_of(simd::Level level)
+    {
+        switch(level)
+        {
+#ifdef SIMD_X86
+            case simd::Level::avx2 :
+                return Kernels{level, first_intersecting_row_avx2, rows_intersect_avx2};
+            case simd::Level::sse41 :
+                return Kernels{level, first_intersecting_row_sse41, rows_intersect_sse41};
+#endif
+            default :
+                return Kernels{simd::Level::scalar, first_intersecting_row_scalar, rows_intersect_scalar};
+        }
+    }
+
+    // The kernels in use. They are the scalar ones until the best supported ones are
+    // selected at startup, so that a grid used by another static initializer still works.
+    Kernels kernels{simd::Level::scalar, first_intersecting_row_scalar, rows_intersect_scalar};
+    const bool is_selected=simd::set_level(simd::detected_level());
+}
+
+namespace simd
+{
+    Level detected_level()
+    {
+#ifdef SIMD_X86
+        __builtin_cpu_init();
+        if(__builtin_cpu_supports("avx2")) return Level::avx2;
+        if(__builtin_cpu_supports("sse4.1")) return Level::sse41;
+#endif
+        return Level::scalar;
+    }
+
+    Level level()
+    {
+        return kernels.level;
+    }
+
+    bool set_level(Level level)
+    {
+        if(level>detected_level()) return false;
+        kernels=kernels_of(level);
+        return true;
+    }
+
+    const char* level_name(Level level)
+    {
+        switch(level)
+        {
+            case Level::avx2 :
+                return "avx2";
+            case Level::sse41 :
+                return "sse4.1";
+            default :
+                return "scalar";
+        }
+    }
+
+    std::size_t first_intersecting_row(const std::uint64_t* rows, std::size_t begin, std::size_t end, std::uint64_t mask)
+    {
+        return kernels.first_intersecting_row(rows, begin, end, mask);
+    }
+
+    bool rows_intersect(const std::uint64_t* rows, const std::uint64_t* masks, unsigned int count, unsigned int shift)
+    {
+        return kernels.rows_intersect(rows, masks, count, shift);
+    }
+}
@@ -0,0 +1,138 @@
+/**
+ * \file simulation.cpp
+ * \brief This file contains the definitions of the move policies and of the
+ * functions running batches of headless games.
+ * \author Alexandre Bleuler - Bonaventure Dohemeto
+ * \version 2.0
+ * \date 18/10/2026
+ */
+
+#include <algorithm>
+#include <chrono>
+#include <iomanip>
+
+#include "ai.h"
+#include "parallel.h"
+#include "simulation.h"
+
+//////////////////////////////
+////// Move policies /////////
+//////////////////////////////
+
+Move RandomPolicy::choose(const Game& game)
+{
+    (void)game;
+    static constexpr Move moves[] = {
+        Move::left,
+        Move::right,
+        Move::down,
+        Move::clock_rotation,
+        Move::anticlock_rotation,
+        Move::none
+    };
+    std::uniform_int_distribution<int> distribution(0, 5);
+    return moves[distribution(_random)];
+}
+
+std::unique_ptr<MovePolicy> make_policy(const std::string& name)
+{
+    if(name=="idle") return std::make_unique<IdlePolicy>();
+    if(name=="random") return std::make_unique<RandomPolicy>();
+    if(name=="ai") return std::make_unique<AiPolicy>();
+    return nullptr;
+}
+
+bool generator_policy_from_name(const std::string& name, GeneratorPolicy& policy)
+{
+    if(name=="uniform") policy=GeneratorPolicy::uniform;
+    else if(name=="bag") policy=GeneratorPolicy::bag;
+    else if(name=="history") policy=GeneratorPolicy::history;
+    else return false;
+    return true;
+}
+
+//////////////////////////////
+////// Simulation ////////////
+//////////////////////////////
+
+std::uint64_t game_seed(std::uint64_t seed, std::uint64_t index)
+{
+    // splitmix64 step, so that neighbouring indexes give unrelated seeds.
+    return mix64(seed + (index+1)*0x9E3779B97F4A7C15ull);
+}
+
+GameResult play_game(const SimulationConfig& config, std::uint64_t seed, MovePolicy& policy)
+{
+    Game game{config.rows, config.columns, seed, config.ticks_per_second, config.generator};
+    policy.reset(seed);
+    while(!game.is_over() && game.tick_count()<config.max_ticks)
+    {
+        Move move=policy.choose(game);
+        if(move!=Move::none) game.input(move);
+        game.tick();
+        game.clear_events();
+    }
+    GameResult result;
+    result.seed=seed;
+    result.score=game.score();
+    result.pieces=game.piece_count();
+    result.ticks=game.tick_count();
+    result.is_over=game.is_over();
+    return result;
+}
+
+SimulationResult run_simulation(const SimulationConfig& config)
+{
+    SimulationResult result;
+    unsigned int threads=thread_count(config.threads);
+    std::vector<std::unique_ptr<MovePolicy>> policies;
+    for(unsigned int worker=0; worker<threads; ++worker)
+    {
+        policies.push_back(make_policy(config.policy));
+        if(!policies.back()) return result;
+    }
+
+    result.games.resize(config.games);
+    auto start=std::chrono::steady_clock::now();
+    parallel_for(config.games, threads, [&](unsigned int worker, std::size_t index)
+    {
+        result.games[index]=play_game(config, game_seed(config.seed, index), *policies[worker]);
+    });
+    result.seconds=std::chrono::duration<double>(std::chrono::steady_clock::now()-start).count();
+    return result;
+}
+
+void print_report(std::ostream& out, const SimulationResult& result)
+{
+    std::size_t games=result.games.size();
+    out<<"games       : "<<games<<'\n';
+    if(games==0) return;
+
+    std::uint64_t pieces=0;
+    std::uint64_t ticks=0;
+    std::size_t stopped=0;
+    std::vector<unsigned int> scores;
+    scores.reserve(games);
+    for(const GameResult& game : result.games)
+    {
+        pieces+=game.pieces;
+        ticks+=game.ticks;
+        if(!game.is_over) ++stopped;
+        scores.push_back(game.score);
+    }
+    std::sort(scores.begin(), scores.end());
+    double mean=0;
+    for(unsigned int score : scores) mean+=score;
+    mean/=games;
+    auto quantile=[&scores](double q){return scores[static_cast<std::size_t>(q*(scores.size()-1))];};
+
+    double seconds= result.seconds>0 ? result.seconds : 1e-9;
+    out<<std::fixed<<std::setprecision(2);
+    out<<"stopped     : "<<stopped<<" (tick budget spent)\n";
+    out<<"duration    : "<<result.seconds<<" s\n";
+    out<<"games/s     : "<<games/seconds<<'\n';
+    out<<"pieces/s    : "<<pieces/seconds<<'\n';
+    out<<"ticks/s     : "<<ticks/seconds<<'\n';
+    out<<"score       : min "<<scores.front()<<", mean "<<mean<<", median "<<quantile(0.5)
+       <<", p90 "<<quantile(0.9)<<", p99 "<<quantile(0.99)<<", max "<<scores.back()<<'\n';
+}
@@ -0,0 +1,70 @@
+/**
+ * \file transposition.cpp
+ * \brief This file contains the definitions of the transposition table.
+ * \author Alexandre Bleuler - Bonaventure Dohemeto
+ * \version 2.0
+ * \date 18/10/2026
+ */
+
+#include <cstring>
+
+#include "transposition.h"
+
+namespace
+{
+    std::uint64_t bits_of(double score)
+    {
+        std::uint64_t bits;
+        std::memcpy(&bits, &score, sizeof bits);
+        return bits;
+    }
+
+    double score_of(std::uint64_t bits)
+    {
+        double score;
+        std::memcpy(&score, &bits, sizeof score);
+        return score;
+    }
+}
+
+TranspositionTable::TranspositionTable(std::size_t size)
+{
+    std::size_t slots=1;
+    while(slots<size) slots<<=1;
+    _slots.reset(new Slot[slots]);
+    _mask=slots-1;
+    // An empty slot has to be a miss for every key, the key 0 included.
+    clear();
+}
+
+std::uint64_t TranspositionTable::key(std::uint64_t grid_hash, PieceType piece, PieceType next)
+{
+    return mix64(grid_hash+(static_cast<std::uint64_t>(piece)*8+static_cast<std::uint64_t>(next)+1)*0x9E3779B97F4A7C15ull);
+}
+
+bool TranspositionTable::probe(std::uint64_t key, double& score) const
+{
+    const Slot& slot=_slots[key & _mask];
+    std::uint64_t data=slot.data.load(std::memory_order_relaxed);
+    if((slot.check.load(std::memory_order_relaxed) ^ data)!=key) return false;
+    score=score_of(data);
+    return true;
+}
+
+void TranspositionTable::store(std::uint64_t key, double score)
+{
+    Slot& slot=_slots[key & _mask];
+    std::uint64_t data=bits_of(score);
+    slot.check.store(key ^ data, std::memory_order_relaxed);
+    slot.data.store(data, std::memory_order_relaxed);
+}
+
+void TranspositionTable::clear()
+{
+    for(std::size_t index=0; index<=_mask; ++index)
+    {
+        // The check of an empty slot matches no key of this slot.
+        _slots[index].data.store(0, std::memory_order_relaxed);
+        _slots[index].check.store(~std::uint64_t{index}, std::memory_order_relaxed);
+    }
+}
@@ -0,0 +1,130 @@
+/**
+ * \file test_ai.cpp
+ * \brief A series of Catch2 tests to ensure the good functionning
+ *  of the automatic player.
+ * \author Alexandre Bleuler - Bonaventure Dohemeto
+ * \version 2.0
+ * \date 18/10/2026
+ */
+
+
+#include "catch2/catch_test_macros.hpp"
+#include "ai.h"
+
+
+TEST_CASE("evaluate_grid")
+{
+    Grid grid{10,4};
+    Block block;
+    grid(9,0).fill(block);
+    grid(7,0).fill(block);
+    grid(9,2).fill(block);
+    // Heights 3, 0, 1, 0 : sum 4, bumpiness 3+1+1, one hole.
+    AiWeights weights{-1, 10, -100, -1000};
+    REQUIRE(evaluate_grid(grid, 2, weights)==-4+20-100-5000);
+}
+
+TEST_CASE("AiPolicy, chooses the clearing placement")
+{
+    // Four rows full but for the last column : a vertical I clears them all.
+    Grid grid{20,10};
+    Block block;
+    for(unsigned int row=16; row<20; ++row)
+    {
+        for(unsigned int column=0; column<9; ++column) grid(row, column).fill(block);
+    }
+    AiPolicy policy;
+    REQUIRE(policy.plan(grid, Piece{PieceType::I, 0, 5}, PieceType::O));
+    for(const Block& piece_block : policy.target().piece().blocks())
+    {
+        REQUIRE(piece_block.column()==9);
+        REQUIRE(piece_block.row()>=16);
+    }
+    REQUIRE(policy.evaluated_grids()>17);
+}
+
+TEST_CASE("AiPolicy, plays games")
+{
+    SimulationConfig config;
+    config.max_ticks=20000;
+    AiPolicy policy;
+    GameResult result=play_game(config, 12, policy);
+    // The automatic player survives the whole tick budget and clears rows.
+    REQUIRE(!result.is_over);
+    REQUIRE(result.score>0);
+    REQUIRE(result.pieces>500);
+    REQUIRE(make_policy("ai")!=nullptr);
+
+    // With a tiny budget, a placement is still chosen for every piece.
+    AiPolicy hurried{AiWeights{}, std::chrono::microseconds{1}};
+    Game game{20, 10, 3};
+    REQUIRE(hurried.plan(game));
+    REQUIRE(hurried.evaluated_grids()>0);
+    unsigned int locked=0;
+    while(locked<20 && !game.is_over())
+    {
+        Move move=hurried.choose(game);
+        if(move!=Move::none) game.input(move);
+        game.tick();
+        locked=game.piece_count();
+    }
+    REQUIRE(locked==20);
+}
+
+TEST_CASE("AiPolicy, parallel search")
+{
+    // Whatever the number of threads, the same placements are chosen along a game.
+    AiPolicy sequential;
+    AiPolicy parallel{AiWeights{}, std::chrono::microseconds{0}, 4};
+    REQUIRE(sequential.threads()==1);
+    REQUIRE(parallel.threads()==4);
+    Game game{20, 10, 8};
+    std::uint64_t pruned=0;
+    while(game.piece_count()<60 && !game.is_over())
+    {
+        REQUIRE(sequential.plan(game));
+        REQUIRE(parallel.plan(game));
+        REQUIRE(parallel.target().type==sequential.target().type);
+        REQUIRE(parallel.target().rotation==sequential.target().rotation);
+        REQUIRE(parallel.target().row==sequential.target().row);
+        REQUIRE(parallel.target().column==sequential.target().column);
+        pruned+=sequential.pruned_placements();
+
+        std::uint64_t pieces=game.piece_count();
+        while(game.piece_count()==pieces && !game.is_over())
+        {
+            Move move=parallel.choose(game);
+            if(move!=Move::none) game.input(move);
+            game.tick();
+        }
+    }
+    REQUIRE(!game.is_over());
+    // The upper bound of the two-ply scores skips some placements.
+    REQUIRE(pruned>0);
+}
+
+TEST_CASE("AiPolicy, transposition table")
+{
+    // Planning the same piece again finds every two-ply score in the table.
+    Grid grid{20,10};
+    Block block;
+    for(unsigned int column=0; column<9; ++column) grid(19, column).fill(block);
+    AiPolicy policy;
+    Piece piece{PieceType::L, 0, 5};
+    REQUIRE(policy.plan(grid, piece, PieceType::J));
+    Placement first=policy.target();
+    std::uint64_t grids=policy.evaluated_grids();
+    REQUIRE(policy.cache_hits()==0);
+
+    REQUIRE(policy.plan(grid, piece, PieceType::J));
+    REQUIRE(policy.cache_hits()>0);
+    REQUIRE(policy.evaluated_grids()<grids);
+    std::uint64_t replanned=policy.evaluated_grids();
+    REQUIRE(policy.target().rotation==first.rotation);
+    REQUIRE(policy.target().row==first.row);
+    REQUIRE(policy.target().column==first.column);
+
+    // Another next piece is another entry.
+    REQUIRE(policy.plan(grid, piece, PieceType::S));
+    REQUIRE(policy.evaluated_grids()>replanned);
+}
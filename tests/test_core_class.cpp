@@ -10,7 +10,11 @@
 
 #include "catch2/catch_test_macros.hpp"
 #include "core_class.h"
+#include <algorithm>
+#include <functional>
+#include <vector>
 #include <string>
+#include <stdexcept>
 
 
 //////////////////////////////// 
@@ -68,6 +72,52 @@ TEST_CASE("Piece colors")
     REQUIRE(piece[0].color()==Color::green);
 }
 
+TEST_CASE("Piece rotations")
+{
+    Piece piece {PieceType::L, 5, 5};
+    REQUIRE(piece.rotation()==0);
+    REQUIRE(piece[3].row()==6);
+    REQUIRE(piece[3].column()==4);
+
+    piece.move(Move::clock_rotation);
+    REQUIRE(piece.rotation()==1);
+    REQUIRE(piece.pivot_row()==5);
+    REQUIRE(piece.pivot_col()==5);
+    REQUIRE(piece[1].row()==4);
+    REQUIRE(piece[1].column()==5);
+    REQUIRE(piece[3].row()==4);
+    REQUIRE(piece[3].column()==4);
+
+    piece.move(Move::anticlock_rotation, 3);
+    REQUIRE(piece.rotation()==0);
+    piece.move(Move::anticlock_rotation);
+    REQUIRE(piece.rotation()==3);
+    for(unsigned int turn=0; turn<4; ++turn) piece.move(Move::clock_rotation);
+    REQUIRE(piece.rotation()==3);
+
+    Piece o_piece {PieceType::O, 5, 5};
+    o_piece.move(Move::clock_rotation);
+    for(unsigned int block=0; block<4; ++block)
+    {
+        REQUIRE(o_piece[block].row()==Piece(PieceType::O, 5, 5)[block].row());
+        REQUIRE(o_piece[block].column()==Piece(PieceType::O, 5, 5)[block].column());
+    }
+}
+
+TEST_CASE("Piece::blocks")
+{
+    Piece piece {PieceType::S, 3, 4, 1};
+    std::array<Block, 4> blocks=piece.blocks();
+    for(unsigned int i=0; i<piece.size(); ++i)
+    {
+        REQUIRE(blocks[i].row()==piece[i].row());
+        REQUIRE(blocks[i].column()==piece[i].column());
+        REQUIRE(blocks[i].color()==Color::red);
+    }
+    REQUIRE(blocks[0].row()==3);
+    REQUIRE(blocks[0].column()==4);
+}
+
 ///////////////////////////////
 ////////  Testing grid //////// 
 ///////////////////////////////
@@ -379,4 +429,483 @@ TEST_CASE("Grid::update")
     is_game_over= grid.update();
     REQUIRE(is_game_over==true);
     REQUIRE(get_grid(grid)==expected_grid);
-}
\ No newline at end of file
+}
+
+TEST_CASE("Grid::row_mask, packed occupancy")
+{
+    Grid grid{10,11};
+    grid.put_piece(PieceType::I);
+    REQUIRE(grid.row_mask(0)==0b1111000);
+    REQUIRE(grid.row_mask(1)==0);
+    grid(1,10).clear();
+    REQUIRE(grid.row_mask(1)==0);
+    Block block;
+    grid(1,10).fill(block);
+    REQUIRE(grid.row_mask(1)==(1u<<10));
+    REQUIRE(grid(1,10).is_full()==true);
+
+    Grid wide_grid{4,64};
+    for(unsigned int j=0; j<64; ++j) wide_grid(3,j).fill(block);
+    REQUIRE(wide_grid.row_mask(3)==~std::uint64_t{0});
+    wide_grid.update();
+    REQUIRE(wide_grid.row_mask(3)==0);
+    REQUIRE(wide_grid.score()==64);
+
+    REQUIRE_THROWS_AS(Grid(4,65), std::invalid_argument);
+}
+
+TEST_CASE("Grid::update, colors follow their rows")
+{
+    Grid grid{8,4};
+    Block red_block{0,0,Color::red};
+    Block blue_block{0,0,Color::blue};
+    Block green_block{0,0,Color::green};
+    grid(2,1).fill(green_block);
+    grid(4,3).fill(blue_block);
+    for(unsigned int j=0; j<4; ++j)
+    {
+        grid(3,j).fill(red_block);
+        grid(5,j).fill(red_block);
+        grid(7,j).fill(red_block);
+    }
+    grid(6,0).fill(blue_block);
+    grid.update();
+    REQUIRE(grid.score()==5*4*3);
+    REQUIRE(grid(5,1).color()==Color::green);
+    REQUIRE(grid(6,3).color()==Color::blue);
+    REQUIRE(grid(7,0).color()==Color::blue);
+    REQUIRE(grid(7,1).color()==Color::none);
+    REQUIRE(grid(2,1).color()==Color::none);
+    REQUIRE(grid.row_mask(5)==0b0010);
+    REQUIRE(grid.row_mask(6)==0b1000);
+    REQUIRE(grid.row_mask(7)==0b0001);
+}
+
+TEST_CASE("Grid::update, repeated clears on a tall grid")
+{
+    Grid grid{100,10};
+    Block purple_block{0,0,Color::purple};
+    Block orange_block{0,0,Color::orange};
+    grid(50,2).fill(orange_block);
+    for(unsigned int turn=0; turn<3; ++turn)
+    {
+        for(unsigned int j=0; j<10; ++j)
+        {
+            grid(99,j).fill(purple_block);
+            grid(98,j).fill(purple_block);
+        }
+        grid(97,turn).fill(orange_block);
+        grid.update();
+        REQUIRE(grid.row_mask(99)==(1u<<turn));
+        REQUIRE(grid(99,turn).color()==Color::orange);
+    }
+    REQUIRE(grid.score()==3*3*10*2);
+    REQUIRE(grid(56,2).color()==Color::orange);
+    for(unsigned int row=0; row<99; ++row)
+    {
+        REQUIRE(grid.row_mask(row)==(row==56 ? 0b100u : 0u));
+    }
+}
+
+TEST_CASE("Grid::update, full rows tracked through fills and clears")
+{
+    Grid grid{10,4};
+    std::string expected_grid=set_empty_grid(10,4);
+    Block block;
+    for(unsigned int j=0; j<4; ++j)
+    {
+        grid(9,j).fill(block);
+        grid(8,j).fill(block);
+    }
+    grid(9,1).fill(block);
+    grid(8,2).clear();
+    expected_grid[1+9*5+0]='O';
+    expected_grid[1+9*5+1]='O';
+    expected_grid[1+9*5+3]='O';
+    grid.update();
+    REQUIRE(grid.score()==4);
+    REQUIRE(get_grid(grid)==expected_grid);
+
+    grid(9,2).fill(block);
+    grid.update();
+    REQUIRE(grid.score()==8);
+    REQUIRE(get_grid(grid)==set_empty_grid(10,4));
+}
+
+TEST_CASE("Grid::can_place and Grid::test_move")
+{
+    Grid grid{10,11};
+    Piece piece=grid.put_piece(PieceType::T);
+    std::string expected_grid=get_grid(grid);
+
+    REQUIRE(grid.can_place(piece)==false);
+    REQUIRE(grid.can_place(Piece{PieceType::T, 5, 5})==true);
+    REQUIRE(grid.can_place(Piece{PieceType::I, 5, 0})==false);
+
+    REQUIRE(grid.test_move(piece, Move::down)==true);
+    REQUIRE(grid.test_move(piece, Move::down, 8)==true);
+    REQUIRE(grid.test_move(piece, Move::down, 9)==false);
+    REQUIRE(grid.test_move(piece, Move::up)==false);
+    REQUIRE(grid.test_move(piece, Move::left, 4)==true);
+    REQUIRE(grid.test_move(piece, Move::left, 5)==false);
+    REQUIRE(grid.test_move(piece, Move::anticlock_rotation)==false);
+    REQUIRE(get_grid(grid)==expected_grid);
+
+    Block block;
+    grid(3,5).fill(block);
+    REQUIRE(grid.test_move(piece, Move::down)==true);
+    REQUIRE(grid.test_move(piece, Move::down, 2)==false);
+    REQUIRE(grid.move_piece(piece, Move::down, 2)==false);
+    REQUIRE(piece.pivot_row()==0);
+}
+
+/////////////////////////////////////////
+//////// Testing PieceGenerator ////////
+///////////////////////////////////////
+
+TEST_CASE("PieceGenerator, reproducible sequences")
+{
+    PieceGenerator first{42};
+    PieceGenerator second{42};
+    PieceGenerator other{43};
+    bool differs=false;
+    for(unsigned int i=0; i<300; ++i)
+    {
+        PieceType type=first.next();
+        REQUIRE(type==second.next());
+        if(type!=other.next()) differs=true;
+    }
+    REQUIRE(differs);
+
+    first.reset(42);
+    second.reset(42);
+    PieceType pieces[100];
+    first.fill(pieces, 100);
+    for(PieceType type : pieces) REQUIRE(type==second.next());
+
+    REQUIRE(first.seed()==42);
+    REQUIRE_THROWS_AS(PieceGenerator(0, GeneratorPolicy::history, PieceGenerator::max_history+1), std::invalid_argument);
+}
+
+TEST_CASE("PieceGenerator, peek")
+{
+    PieceGenerator generator{7, GeneratorPolicy::bag};
+    PieceGenerator reference{7, GeneratorPolicy::bag};
+    PieceType pieces[400];
+    reference.fill(pieces, 400);
+
+    // Peeking further than a block of the queue.
+    REQUIRE(generator.peek(200)==pieces[200]);
+    for(unsigned int i=0; i<300; ++i)
+    {
+        REQUIRE(generator.peek()==pieces[i]);
+        REQUIRE(generator.peek(3)==pieces[i+3]);
+        REQUIRE(generator.next()==pieces[i]);
+    }
+}
+
+TEST_CASE("PieceGenerator, policies")
+{
+    // Uniform : every type shows up with a frequency close to 1/7.
+    PieceGenerator uniform{1};
+    unsigned int counts[7]={0};
+    for(unsigned int i=0; i<70000; ++i) ++counts[static_cast<int>(uniform.next())];
+    for(unsigned int count : counts)
+    {
+        REQUIRE(count>9500);
+        REQUIRE(count<10500);
+    }
+
+    // Bag : each group of 7 pieces contains the 7 types.
+    PieceGenerator bag{2, GeneratorPolicy::bag};
+    for(unsigned int group=0; group<50; ++group)
+    {
+        bool seen[7]={false};
+        for(unsigned int i=0; i<7; ++i) seen[static_cast<int>(bag.next())]=true;
+        for(bool type_seen : seen) REQUIRE(type_seen);
+    }
+
+    // History : with enough tries, a piece is never one of the last ones.
+    PieceGenerator history{3, GeneratorPolicy::history, 2, 1000};
+    PieceType before_last=history.next();
+    PieceType last=history.next();
+    REQUIRE(before_last!=last);
+    for(unsigned int i=0; i<500; ++i)
+    {
+        PieceType type=history.next();
+        REQUIRE(type!=last);
+        REQUIRE(type!=before_last);
+        before_last=last;
+        last=type;
+    }
+}
+
+TEST_CASE("Grid::drop_distance and Grid::hard_drop")
+{
+    Grid grid{10,6};
+    Piece piece=grid.put_piece(PieceType::T);
+    REQUIRE(grid.drop_distance(piece)==8);
+
+    // An obstacle under the pivot's column only.
+    Block block;
+    grid(6,3).fill(block);
+    REQUIRE(grid.drop_distance(piece)==4);
+
+    // Cells above the piece don't matter.
+    grid(0,0).fill(block);
+    grid.move_piece(piece, Move::down, 4);
+    REQUIRE(grid.drop_distance(piece)==0);
+    REQUIRE(grid.hard_drop(piece)==0);
+
+    // The dropped piece lands where repeated moves down would bring it.
+    Grid dropped_grid{12,8};
+    Grid moved_grid{12,8};
+    for(unsigned int column : {0u, 2u, 3u, 7u})
+    {
+        dropped_grid(11-column/2, column).fill(block);
+        moved_grid(11-column/2, column).fill(block);
+    }
+    for(unsigned int type=0; type<7; ++type)
+    {
+        for(unsigned int rotation=0; rotation<4; ++rotation)
+        {
+            Grid dropped=dropped_grid;
+            Grid moved=moved_grid;
+            Piece dropped_piece=dropped.put_piece(static_cast<PieceType>(type), 1);
+            Piece moved_piece=moved.put_piece(static_cast<PieceType>(type), 1);
+            for(unsigned int i=0; i<rotation; ++i)
+            {
+                dropped.move_piece(dropped_piece, Move::clock_rotation);
+                moved.move_piece(moved_piece, Move::clock_rotation);
+            }
+            unsigned int distance=0;
+            while(moved.move_piece(moved_piece, Move::down)) ++distance;
+            REQUIRE(dropped.drop_distance(dropped_piece)==distance);
+            REQUIRE(dropped.move_piece(dropped_piece, Move::hard_drop)==true);
+            REQUIRE(dropped_piece.pivot_row()==moved_piece.pivot_row());
+            REQUIRE(get_grid(dropped)==get_grid(moved));
+        }
+    }
+}
+
+namespace
+{
+    // Computes the height and the holes of a column by scanning the whole grid.
+    void scan_column(const Grid& grid, unsigned int column, unsigned int& height, unsigned int& holes)
+    {
+        height=0;
+        holes=0;
+        for(unsigned int row=grid.column_size(); row-->0;)
+        {
+            if(grid(row, column).is_full()) height=grid.column_size()-row;
+        }
+        for(unsigned int row=grid.column_size()-height; row<grid.column_size(); ++row)
+        {
+            if(!grid(row, column).is_full()) ++holes;
+        }
+    }
+
+    // Plays up to 40 pieces on a grid, each moved 6 times at random before being dropped,
+    // and calls check after each update with the result of the update. It stops at game over.
+    void play_random_pieces(Grid& grid, unsigned int seed, const std::function<void(bool is_over)>& check)
+    {
+        PieceGenerator generator{seed};
+        unsigned int state=seed;
+        for(unsigned int pieces=0; pieces<40; ++pieces)
+        {
+            Piece piece=grid.put_piece(generator.next(), 1);
+            for(unsigned int i=0; i<6; ++i)
+            {
+                state=state*1103515245u+12345u;
+                grid.move_piece(piece, static_cast<Move>(1+(state>>16)%5));
+            }
+            grid.hard_drop(piece);
+            bool is_over=grid.update();
+            check(is_over);
+            if(is_over) return;
+        }
+    }
+}
+
+TEST_CASE("Grid, column heights and holes")
+{
+    Grid grid{10,5};
+    Block block;
+    REQUIRE(grid.column_heights()==std::vector<unsigned int>(5, 0));
+    REQUIRE(grid.holes()==0);
+
+    grid(9,0).fill(block);
+    grid(6,0).fill(block);
+    grid(8,1).fill(block);
+    REQUIRE(grid.column_height(0)==4);
+    REQUIRE(grid.column_holes(0)==2);
+    REQUIRE(grid.column_height(1)==2);
+    REQUIRE(grid.column_holes(1)==1);
+    REQUIRE(grid.holes()==3);
+
+    // Clearing the top cell of a column lowers it to the next full cell.
+    grid(6,0).clear();
+    REQUIRE(grid.column_height(0)==1);
+    REQUIRE(grid.column_holes(0)==0);
+    // Filling a cell twice counts it once.
+    grid(8,1).fill(block);
+    REQUIRE(grid.column_holes(1)==1);
+
+    // A piece moved away only lowers its former columns once locked.
+    Grid moving_grid{10,5};
+    Piece piece=moving_grid.put_piece(PieceType::O, 2);
+    REQUIRE(moving_grid.column_height(2)==8);
+    moving_grid.move_piece(piece, Move::left);
+    REQUIRE(moving_grid.column_height(0)==8);
+    REQUIRE(moving_grid.column_height(2)==8);
+    moving_grid.update();
+    REQUIRE(moving_grid.column_height(2)==0);
+    REQUIRE(moving_grid.column_height(1)==8);
+    REQUIRE(moving_grid.holes()==12);
+
+    // Suppressing a row under an overhang.
+    for(unsigned int column=0; column<5; ++column) grid(7,column).fill(block);
+    grid(5,4).fill(block);
+    grid.update();
+    REQUIRE(grid.column_heights()==std::vector<unsigned int>({1, 2, 0, 0, 4}));
+    REQUIRE(grid.column_holes(4)==3);
+
+    // Random games : the maintained values match a full scan.
+    for(unsigned int seed=0; seed<20; ++seed)
+    {
+        Grid random_grid{16,7};
+        play_random_pieces(random_grid, seed, [&](bool is_over)
+        {
+            if(is_over) return;
+            for(unsigned int column=0; column<7; ++column)
+            {
+                unsigned int height, holes;
+                scan_column(random_grid, column, height, holes);
+                REQUIRE(random_grid.column_height(column)==height);
+                REQUIRE(random_grid.column_holes(column)==holes);
+            }
+        });
+    }
+}
+
+TEST_CASE("Grid::hash")
+{
+    // The hash depends on the size of the grid and its full cells only.
+    REQUIRE(Grid{10,4}.hash()==Grid{10,4}.hash());
+    REQUIRE(Grid{10,4}.hash()!=Grid{11,4}.hash());
+    REQUIRE(Grid{10,4}.hash()!=Grid{10,5}.hash());
+
+    Grid grid{10,4};
+    Grid other{10,4};
+    Block red{0, 0, Color::red};
+    Block blue{0, 0, Color::blue};
+    std::uint64_t empty=grid.hash();
+    grid(9,0).fill(red);
+    grid(8,1).fill(red);
+    REQUIRE(grid.hash()!=empty);
+    other(8,1).fill(blue);
+    other(9,0).fill(blue);
+    REQUIRE(grid.hash()==other.hash());
+    grid(8,1).fill(red);
+    REQUIRE(grid.hash()==other.hash());
+    grid(8,1).clear();
+    grid(9,0).clear();
+    grid(9,0).clear();
+    REQUIRE(grid.hash()==empty);
+
+    // A piece moved back to its place restores the hash.
+    Piece piece=grid.put_piece(PieceType::T, 1);
+    std::uint64_t placed=grid.hash();
+    grid.move_piece(piece, Move::left);
+    grid.move_piece(piece, Move::clock_rotation);
+    REQUIRE(grid.hash()!=placed);
+    grid.move_piece(piece, Move::anticlock_rotation);
+    grid.move_piece(piece, Move::right);
+    REQUIRE(grid.hash()==placed);
+
+    // Random games : the maintained hash matches the one of a grid filled cell by cell.
+    for(unsigned int seed=0; seed<20; ++seed)
+    {
+        Grid random_grid{16,7};
+        play_random_pieces(random_grid, seed, [&](bool is_over)
+        {
+            if(is_over) return;
+            Grid copy{16,7};
+            for(unsigned int row=0; row<16; ++row)
+            {
+                for(unsigned int column=0; column<7; ++column)
+                {
+                    if(random_grid(row, column).is_full()) copy(row, column).fill(red);
+                }
+            }
+            REQUIRE(random_grid.hash()==copy.hash());
+        });
+    }
+}
+
+TEST_CASE("Grid, dirty cells")
+{
+    // The tracking is off for a new grid and for a copy.
+    Grid grid{6,4};
+    Block red{0, 0, Color::red};
+    Block blue{0, 0, Color::blue};
+    grid(5,1).fill(red);
+    REQUIRE(grid.is_tracking_dirty()==false);
+    REQUIRE(grid.dirty_rows().empty());
+    REQUIRE(grid.dirty_cells(5)==0);
+    grid.set_dirty_tracking(true);
+    REQUIRE(grid.dirty_rows().size()==6);
+    REQUIRE(grid.dirty_cells(5)==0b1111);
+    Grid copy=grid;
+    REQUIRE(copy.is_tracking_dirty()==false);
+    copy(4,1).fill(red);
+    REQUIRE(copy.dirty_rows().empty());
+    copy=grid;
+    REQUIRE(copy.is_tracking_dirty()==false);
+    grid(5,1).clear();
+    grid.clear_dirty();
+    REQUIRE(grid.dirty_rows().empty());
+    REQUIRE(grid.dirty_cells(5)==0);
+
+    // A filled or recolored cell is dirty, a cell filled again with its color isn't.
+    grid(5,1).fill(red);
+    REQUIRE(grid.dirty_rows()==std::vector<unsigned int>({5}));
+    REQUIRE(grid.dirty_cells(5)==0b0010);
+    grid.clear_dirty();
+    grid(5,1).fill(red);
+    REQUIRE(grid.dirty_rows().empty());
+    grid(5,1).fill(blue);
+    REQUIRE(grid.dirty_cells(5)==0b0010);
+    grid.clear_dirty();
+    grid(4,3).clear();
+    REQUIRE(grid.dirty_rows().empty());
+
+    // Random games : every cell whose color changed since the last drawing is dirty.
+    for(unsigned int seed=0; seed<20; ++seed)
+    {
+        Grid random_grid{16,7};
+        std::vector<Color> drawn(16*7, Color::none);
+        random_grid.set_dirty_tracking(true);
+        random_grid.clear_dirty();
+        play_random_pieces(random_grid, seed, [&](bool)
+        {
+            for(unsigned int row=0; row<16; ++row)
+            {
+                for(unsigned int column=0; column<7; ++column)
+                {
+                    Color color=random_grid(row, column).color();
+                    if(color!=drawn[row*7+column])
+                    {
+                        REQUIRE(((random_grid.dirty_cells(row)>>column) & 1u)==1);
+                        drawn[row*7+column]=color;
+                    }
+                }
+            }
+            // The rows are listed once.
+            std::vector<unsigned int> rows=random_grid.dirty_rows();
+            std::sort(rows.begin(), rows.end());
+            REQUIRE(std::adjacent_find(rows.begin(), rows.end())==rows.end());
+            random_grid.clear_dirty();
+        });
+    }
+}
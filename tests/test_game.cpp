@@ -0,0 +1,160 @@
+/**
+ * \file test_game.cpp
+ * \brief A series of Catch2 tests to ensure the good functionning
+ *  of the headless game engine.
+ * \author Alexandre Bleuler - Bonaventure Dohemeto
+ * \version 2.0
+ * \date 18/10/2026
+ */
+
+
+#include "catch2/catch_test_macros.hpp"
+#include "core_class.h"
+#include "game.h"
+#include <algorithm>
+
+
+TEST_CASE("Game, gravity")
+{
+    Game game{20, 10, 1};
+    REQUIRE(game.gravity_interval()==36);
+    REQUIRE(game.current().pivot_row()==0);
+
+    for(unsigned int tick=0; tick<35; ++tick) game.tick();
+    REQUIRE(game.current().pivot_row()==0);
+    game.tick();
+    REQUIRE(game.current().pivot_row()==1);
+    REQUIRE(game.tick_count()==36);
+
+    Game fast_game{20, 10, 1, 10};
+    REQUIRE(fast_game.gravity_interval()==6);
+}
+
+TEST_CASE("Game, inputs")
+{
+    Game game{20, 10, 7};
+    unsigned int column=game.current().pivot_col();
+    REQUIRE(game.input(Move::left)==true);
+    REQUIRE(game.current().pivot_col()==column-1);
+    REQUIRE(game.input(Move::up)==false);
+    REQUIRE(game.input(Move::down)==true);
+    REQUIRE(game.current().pivot_row()==1);
+    REQUIRE(game.grid()(game.current()[0].row(), game.current()[0].column()).is_full());
+}
+
+TEST_CASE("Game, locks, events and game over")
+{
+    Game game{20, 10, 3};
+    PieceType next=game.next();
+    while(game.piece_count()==0) game.tick();
+    REQUIRE(game.events().front()==GameEvent::piece_locked);
+    REQUIRE(game.current().type()==next);
+    game.clear_events();
+    REQUIRE(game.events().empty());
+
+    // Without any input, the pieces stack in the middle until the game is over.
+    while(!game.is_over()) game.tick();
+    REQUIRE(game.events().back()==GameEvent::game_over);
+    std::uint64_t ticks=game.tick_count();
+    game.tick();
+    REQUIRE(game.tick_count()==ticks);
+    REQUIRE(game.input(Move::left)==false);
+
+    game.set_dirty_tracking(true);
+    game.clear_dirty();
+    game.reset(3);
+    REQUIRE(game.grid().is_tracking_dirty());
+    REQUIRE(game.grid().dirty_rows().size()==20);
+    REQUIRE(game.is_over()==false);
+    REQUIRE(game.tick_count()==0);
+    REQUIRE(game.score()==0);
+}
+
+TEST_CASE("Game, same seed same pieces")
+{
+    Game first_game{20, 10, 42};
+    Game second_game{20, 10, 42};
+    for(unsigned int piece=0; piece<50; ++piece)
+    {
+        REQUIRE(first_game.current().type()==second_game.current().type());
+        REQUIRE(first_game.next()==second_game.next());
+        first_game.reset(42+piece+1);
+        second_game.reset(42+piece+1);
+    }
+}
+
+TEST_CASE("Game, preview")
+{
+    Game game{20, 10, 11};
+    PieceType pieces[5];
+    game.preview(pieces, 5);
+    REQUIRE(pieces[0]==game.next());
+
+    // Looking ahead doesn't change the sequence : the same game without preview deals the same pieces.
+    Game other_game{20, 10, 11};
+    for(unsigned int i=0; i<5; ++i)
+    {
+        REQUIRE(game.next()==pieces[i]);
+        REQUIRE(other_game.next()==pieces[i]);
+        std::uint64_t count=game.piece_count();
+        while(game.piece_count()==count) game.tick();
+        while(other_game.piece_count()==count) other_game.tick();
+    }
+}
+
+TEST_CASE("Game::advance")
+{
+    for(unsigned int ticks_per_second : {1u, 10u, 60u})
+    {
+        Game ticked{20, 10, 11, ticks_per_second};
+        Game advanced{20, 10, 11, ticks_per_second};
+        for(std::uint64_t steps : {0u, 1u, 5u, 37u, 100u, 1000u})
+        {
+            for(std::uint64_t i=0; i<steps; ++i) ticked.tick();
+            advanced.advance(steps);
+            REQUIRE(advanced.tick_count()==ticked.tick_count());
+            REQUIRE(advanced.piece_count()==ticked.piece_count());
+            REQUIRE(get_grid(advanced.grid())==get_grid(ticked.grid()));
+            REQUIRE(advanced.events()==ticked.events());
+
+            REQUIRE(ticked.input(Move::left)==advanced.input(Move::left));
+        }
+        // Both games end at the same tick.
+        ticked.advance(1000000);
+        while(!advanced.is_over()) advanced.tick();
+        REQUIRE(advanced.tick_count()==ticked.tick_count());
+    }
+}
+
+TEST_CASE("Game, recording")
+{
+    Game game{20, 10, 4};
+    REQUIRE(game.input(Move::right)==true);
+    REQUIRE(game.recorded_moves().empty());
+
+    game.set_recording(true);
+    game.tick();
+    REQUIRE(game.input(Move::left)==true);
+    REQUIRE(game.input(Move::up)==false);
+    REQUIRE(game.recorded_moves().size()==1);
+    REQUIRE(game.recorded_moves()[0].tick==1);
+    REQUIRE(game.recorded_moves()[0].move==Move::left);
+
+    game.reset(5);
+    REQUIRE(game.recorded_moves().empty());
+}
+
+TEST_CASE("Game, hard drop")
+{
+    Game game{20, 10, 8};
+    game.set_recording(true);
+    PieceType next=game.next();
+    REQUIRE(game.input(Move::hard_drop)==true);
+    REQUIRE(game.piece_count()==1);
+    REQUIRE(game.events().front()==GameEvent::piece_locked);
+    REQUIRE(game.current().type()==next);
+    REQUIRE(game.current().pivot_row()==0);
+    REQUIRE(game.grid().row_mask(19)!=0);
+    REQUIRE(game.recorded_moves().back().move==Move::hard_drop);
+    REQUIRE(game.input(Move::none)==false);
+}
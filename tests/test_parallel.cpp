@@ -0,0 +1,75 @@
+/**
+ * \file test_parallel.cpp
+ * \brief A series of Catch2 tests to ensure the good functionning
+ *  of the work-stealing parallel loop.
+ * \author Alexandre Bleuler - Bonaventure Dohemeto
+ * \version 2.0
+ * \date 18/10/2026
+ */
+
+
+#include "catch2/catch_test_macros.hpp"
+#include "parallel.h"
+#include <atomic>
+#include <memory>
+#include <vector>
+
+
+TEST_CASE("parallel_for, every index exactly once")
+{
+    for(unsigned int threads : {1u, 2u, 3u, 8u, 0u})
+    {
+        for(std::size_t count : {std::size_t{0}, std::size_t{1}, std::size_t{7}, std::size_t{1000}})
+        {
+            std::unique_ptr<std::atomic<int>[]> calls{new std::atomic<int>[count]};
+            for(std::size_t index=0; index<count; ++index) calls[index]=0;
+            std::atomic<unsigned int> max_worker{0};
+            parallel_for(count, threads, [&](unsigned int worker, std::size_t index)
+            {
+                ++calls[index];
+                unsigned int seen=max_worker.load();
+                while(worker>seen && !max_worker.compare_exchange_weak(seen, worker)) {}
+            });
+            for(std::size_t index=0; index<count; ++index) REQUIRE(calls[index]==1);
+            REQUIRE(max_worker<thread_count(threads));
+        }
+    }
+}
+
+TEST_CASE("parallel_for, unbalanced jobs are stolen")
+{
+    // The first share is much longer to process, the other workers have to steal it.
+    std::vector<int> done(64, 0);
+    parallel_for(64, 4, [&](unsigned int worker, std::size_t index)
+    {
+        (void)worker;
+        volatile unsigned long sink=0;
+        unsigned long work= index<16 ? 200000 : 10;
+        for(unsigned long step=0; step<work; ++step) sink=sink+step;
+        done[index]=1;
+    });
+    for(int flag : done) REQUIRE(flag==1);
+}
+
+TEST_CASE("ThreadPool, every index exactly once")
+{
+    for(unsigned int threads : {1u, 3u, 8u})
+    {
+        ThreadPool pool{threads};
+        REQUIRE(pool.size()==threads);
+        // The workers are reused from a loop to the next.
+        for(std::size_t count : {std::size_t{0}, std::size_t{1}, std::size_t{7}, std::size_t{1000}, std::size_t{5}})
+        {
+            std::unique_ptr<std::atomic<int>[]> calls{new std::atomic<int>[count]};
+            for(std::size_t index=0; index<count; ++index) calls[index]=0;
+            std::atomic<bool> is_valid_worker{true};
+            pool.parallel_for(count, [&](unsigned int worker, std::size_t index)
+            {
+                ++calls[index];
+                if(worker>=threads) is_valid_worker=false;
+            });
+            for(std::size_t index=0; index<count; ++index) REQUIRE(calls[index]==1);
+            REQUIRE(is_valid_worker);
+        }
+    }
+}
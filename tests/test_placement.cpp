@@ -0,0 +1,100 @@
+/**
+ * \file test_placement.cpp
+ * \brief A series of Catch2 tests to ensure the good functionning
+ *  of the enumeration of the placements of a piece.
+ * \author Alexandre Bleuler - Bonaventure Dohemeto
+ * \version 2.0
+ * \date 18/10/2026
+ */
+
+
+#include "catch2/catch_test_macros.hpp"
+#include "placement.h"
+#include <algorithm>
+#include <array>
+#include <set>
+
+
+// The cells covered by a placement, sorted.
+std::array<std::pair<unsigned int, unsigned int>, 4> cells_of(const Placement& placement)
+{
+    std::array<std::pair<unsigned int, unsigned int>, 4> cells;
+    std::array<Block, 4> blocks=placement.piece().blocks();
+    for(unsigned int i=0; i<4; ++i) cells[i]={blocks[i].row(), blocks[i].column()};
+    std::sort(cells.begin(), cells.end());
+    return cells;
+}
+
+TEST_CASE("PlacementFinder, empty grid")
+{
+    // The well-known counts of the distinct placements on an empty board 10 columns wide.
+    Grid grid{20,10};
+    PlacementFinder finder;
+    const unsigned int expected[7]={17, 9, 34, 34, 34, 17, 17};
+    for(unsigned int type=0; type<7; ++type)
+    {
+        const std::vector<Placement>& placements=finder.find(grid, static_cast<PieceType>(type));
+        REQUIRE(placements.size()==expected[type]);
+
+        std::set<std::array<std::pair<unsigned int, unsigned int>, 4>> distinct;
+        for(const Placement& placement : placements)
+        {
+            REQUIRE(placement.type==static_cast<PieceType>(type));
+            Piece piece=placement.piece();
+            REQUIRE(grid.can_place(piece));
+            // Every placement lies on the floor.
+            unsigned int lowest=0;
+            for(const Block& block : piece.blocks()) lowest=std::max(lowest, block.row());
+            REQUIRE(lowest==19);
+            distinct.insert(cells_of(placement));
+        }
+        REQUIRE(distinct.size()==placements.size());
+    }
+}
+
+TEST_CASE("PlacementFinder, paths and overhangs")
+{
+    // An overhang on the right : the cell under it can only be reached by sliding.
+    Grid grid{10,6};
+    Block block;
+    for(unsigned int column=3; column<6; ++column) grid(7,column).fill(block);
+
+    PlacementFinder finder;
+    const std::vector<Placement>& placements=finder.find(grid, PieceType::O);
+    bool is_tucked=false;
+    std::vector<Move> moves;
+    for(std::size_t index=0; index<placements.size(); ++index)
+    {
+        const Placement& placement=placements[index];
+        if(placement.row==8 && placement.column>=4) is_tucked=true;
+
+        // Following the path from the spawn leads to the placement, where the piece is locked.
+        Grid played=grid;
+        Piece piece=played.put_piece(PieceType::O);
+        finder.path(index, moves);
+        for(Move move : moves) REQUIRE(played.move_piece(piece, move));
+        REQUIRE(piece.rotation()==placement.rotation);
+        REQUIRE(piece.pivot_row()==placement.row);
+        REQUIRE(piece.pivot_col()==placement.column);
+        REQUIRE(played.test_move(piece, Move::down)==false);
+    }
+    REQUIRE(is_tucked);
+
+    // A blocked spawn gives no placement, and the finder can be reused on another grid.
+    Grid full_grid{6,4};
+    for(unsigned int column=0; column<4; ++column) full_grid(0,column).fill(block);
+    REQUIRE(finder.find(full_grid, PieceType::T).empty());
+    REQUIRE(finder.find(Grid{20,10}, PieceType::O).size()==9);
+}
+
+TEST_CASE("Grid::put_piece and Grid::remove_piece")
+{
+    Grid grid{10,6};
+    Piece piece{PieceType::L, 8, 2, 1};
+    grid.put_piece(piece);
+    REQUIRE(grid.can_place(piece)==false);
+    REQUIRE(grid.column_height(2)==3);
+    grid.remove_piece(piece);
+    REQUIRE(grid.can_place(piece)==true);
+    REQUIRE(grid.column_heights()==std::vector<unsigned int>(6, 0));
+}
@@ -0,0 +1,90 @@
+/**
+ * \file test_replay.cpp
+ * \brief A series of Catch2 tests to ensure the good functionning
+ *  of the recording and playback of replays.
+ * \author Alexandre Bleuler - Bonaventure Dohemeto
+ * \version 2.0
+ * \date 18/10/2026
+ */
+
+
+#include "catch2/catch_test_macros.hpp"
+#include "replay.h"
+#include "simulation.h"
+#include <sstream>
+
+
+// Plays a recorded game with random moves until it is over.
+Replay record_random_game(std::uint64_t seed, GeneratorPolicy generator)
+{
+    Game game{20, 10, seed, 10, generator};
+    game.set_recording(true);
+    RandomPolicy policy;
+    policy.reset(seed);
+    while(!game.is_over())
+    {
+        Move move=policy.choose(game);
+        if(move!=Move::none) game.input(move);
+        game.tick();
+        game.clear_events();
+    }
+    return make_replay(game);
+}
+
+TEST_CASE("Replay, playback")
+{
+    for(std::uint64_t seed=0; seed<10; ++seed)
+    {
+        Replay replay=record_random_game(seed, seed%2 ? GeneratorPolicy::bag : GeneratorPolicy::uniform);
+        REQUIRE(replay.moves.size()>0);
+        PlaybackResult result=play_replay(replay);
+        REQUIRE(result.is_valid);
+        REQUIRE(result.is_over);
+        REQUIRE(result.score==replay.score);
+        REQUIRE(result.ticks==replay.ticks);
+
+        // A forged score or a forged move is detected.
+        Replay forged=replay;
+        forged.score+=10;
+        REQUIRE(!play_replay(forged).is_valid);
+        forged=replay;
+        // More moves to the left than the width of the grid.
+        for(unsigned int i=0; i<10; ++i) forged.moves.insert(forged.moves.begin(), TimedMove{0, Move::left});
+        REQUIRE(!play_replay(forged).is_valid);
+    }
+}
+
+TEST_CASE("Replay, binary format")
+{
+    Replay replay=record_random_game(3, GeneratorPolicy::history);
+    replay.seed=0xFEDCBA9876543210ull;
+    std::stringstream stream;
+    write_replay(stream, replay);
+    std::string bytes=stream.str();
+    // The moves take two bytes each as long as they are less than 128 ticks apart.
+    REQUIRE(bytes.size()<2*replay.moves.size()+32);
+
+    Replay read;
+    REQUIRE(read_replay(stream, read));
+    REQUIRE(read.seed==replay.seed);
+    REQUIRE(read.generator==GeneratorPolicy::history);
+    REQUIRE(read.rows==20);
+    REQUIRE(read.columns==10);
+    REQUIRE(read.ticks_per_second==10);
+    REQUIRE(read.ticks==replay.ticks);
+    REQUIRE(read.score==replay.score);
+    REQUIRE(read.moves.size()==replay.moves.size());
+    for(std::size_t i=0; i<read.moves.size(); ++i)
+    {
+        REQUIRE(read.moves[i].tick==replay.moves[i].tick);
+        REQUIRE(read.moves[i].move==replay.moves[i].move);
+    }
+
+    // Truncated or corrupted streams are refused.
+    std::istringstream truncated(bytes.substr(0, bytes.size()-1));
+    REQUIRE(!read_replay(truncated, read));
+    std::string corrupted=bytes;
+    corrupted[0]='X';
+    std::istringstream bad_magic(corrupted);
+    REQUIRE(!read_replay(bad_magic, read));
+}
@@ -0,0 +1,135 @@
+/**
+ * \file test_simd.cpp
+ * \brief A series of Catch2 tests to ensure that the vector kernels on
+ *  occupancy words give the same results as the scalar ones.
+ * \author Alexandre Bleuler - Bonaventure Dohemeto
+ * \version 2.0
+ * \date 18/10/2026
+ */
+
+
+#include "catch2/catch_test_macros.hpp"
+#include "core_class.h"
+#include "simd.h"
+#include <bitset>
+#include <random>
+#include <string>
+#include <vector>
+
+
+namespace
+{
+    // The levels supported by the processor running the tests.
+    std::vector<simd::Level> supported_levels()
+    {
+        std::vector<simd::Level> levels;
+        for(simd::Level level : {simd::Level::scalar, simd::Level::sse41, simd::Level::avx2})
+        {
+            if(level<=simd::detected_level()) levels.push_back(level);
+        }
+        return levels;
+    }
+}
+
+TEST_CASE("simd, levels")
+{
+    REQUIRE(simd::level()==simd::detected_level());
+    REQUIRE(simd::set_level(simd::Level::scalar));
+    REQUIRE(simd::level()==simd::Level::scalar);
+    REQUIRE(simd::set_level(simd::detected_level()));
+    REQUIRE(std::string{simd::level_name(simd::Level::avx2)}=="avx2");
+}
+
+TEST_CASE("simd, kernels match the scalar ones")
+{
+    std::mt19937_64 random{7};
+    std::vector<std::uint64_t> rows(70);
+    for(simd::Level level : supported_levels())
+    {
+        for(unsigned int trial=0; trial<2000; ++trial)
+        {
+            // Sparse rows, so that the scans often run far.
+            for(std::uint64_t& row : rows) row= random()%4==0 ? random() & random() & random() : 0;
+            std::uint64_t mask=std::uint64_t{1}<<(random()%64);
+            std::size_t begin=random()%rows.size();
+            std::size_t end=begin+random()%(rows.size()-begin+1);
+            std::uint64_t masks[4]={random()%16, random()%16, random()%16, random()%16};
+            unsigned int count=1+random()%4;
+            unsigned int shift=random()%61;
+            std::size_t top=random()%(rows.size()-3);
+
+            REQUIRE(simd::set_level(simd::Level::scalar));
+            std::size_t expected_row=simd::first_intersecting_row(rows.data(), begin, end, mask);
+            bool expected_intersection=simd::rows_intersect(rows.data()+top, masks, count, shift);
+
+            REQUIRE(simd::set_level(level));
+            REQUIRE(simd::first_intersecting_row(rows.data(), begin, end, mask)==expected_row);
+            REQUIRE(simd::rows_intersect(rows.data()+top, masks, count, shift)==expected_intersection);
+        }
+    }
+    simd::set_level(simd::detected_level());
+}
+
+TEST_CASE("shape_masks")
+{
+    for(unsigned int type=0; type<7; ++type)
+    {
+        for(unsigned int rotation=0; rotation<4; ++rotation)
+        {
+            const ShapeMask& mask=shape_masks[type][rotation];
+            unsigned int cells=0;
+            for(std::uint64_t row : mask.rows) cells+=std::bitset<64>{row}.count();
+            REQUIRE(cells==4);
+            for(const BlockOffset& offset : piece_shapes[type][rotation])
+            {
+                REQUIRE(((mask.rows[offset.row-mask.top]>>(offset.column-mask.left)) & 1u)==1);
+            }
+        }
+    }
+    REQUIRE(shape_masks[0][0].height==1);
+    REQUIRE(shape_masks[0][0].width==4);
+    REQUIRE(shape_masks[0][1].height==4);
+}
+
+TEST_CASE("Grid::fits at every level")
+{
+    // Random grids : the masks agree with a test of the blocks one by one.
+    std::mt19937_64 random{3};
+    for(simd::Level level : supported_levels())
+    {
+        REQUIRE(simd::set_level(level));
+        for(unsigned int trial=0; trial<30; ++trial)
+        {
+            Grid grid{12, 9};
+            Block block;
+            for(unsigned int row=4; row<12; ++row)
+            {
+                for(unsigned int column=0; column<9; ++column)
+                {
+                    if(random()%3==0) grid(row, column).fill(block);
+                }
+            }
+            for(unsigned int type=0; type<7; ++type)
+            {
+                for(unsigned int rotation=0; rotation<4; ++rotation)
+                {
+                    for(unsigned int row=0; row<14; ++row)
+                    {
+                        for(unsigned int column=0; column<11; ++column)
+                        {
+                            bool expected=true;
+                            for(const BlockOffset& offset : piece_shapes[type][rotation])
+                            {
+                                unsigned int block_row=row+offset.row;
+                                unsigned int block_column=column+offset.column;
+                                if(block_row>=12 || block_column>=9 || grid(block_row, block_column).is_full()) expected=false;
+                            }
+                            REQUIRE(grid.fits(static_cast<PieceType>(type), rotation, row, column)==expected);
+                        }
+                    }
+                }
+            }
+        }
+    }
+    simd::set_level(simd::detected_level());
+}
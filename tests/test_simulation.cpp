@@ -0,0 +1,86 @@
+/**
+ * \file test_simulation.cpp
+ * \brief A series of Catch2 tests to ensure the good functionning
+ *  of the batch simulation of headless games.
+ * \author Alexandre Bleuler - Bonaventure Dohemeto
+ * \version 2.0
+ * \date 18/10/2026
+ */
+
+
+#include "catch2/catch_test_macros.hpp"
+#include "simulation.h"
+#include <sstream>
+
+
+TEST_CASE("make_policy")
+{
+    REQUIRE(make_policy("idle")!=nullptr);
+    REQUIRE(make_policy("random")!=nullptr);
+    REQUIRE(make_policy("unknown")==nullptr);
+}
+
+TEST_CASE("generator_policy_from_name")
+{
+    GeneratorPolicy policy=GeneratorPolicy::uniform;
+    REQUIRE(generator_policy_from_name("bag", policy));
+    REQUIRE(policy==GeneratorPolicy::bag);
+    REQUIRE(generator_policy_from_name("history", policy));
+    REQUIRE(policy==GeneratorPolicy::history);
+    REQUIRE(!generator_policy_from_name("unknown", policy));
+    REQUIRE(policy==GeneratorPolicy::history);
+}
+
+TEST_CASE("run_simulation, reproducible batches")
+{
+    SimulationConfig config;
+    config.games=20;
+    config.seed=5;
+    config.ticks_per_second=1;
+    config.threads=1;
+    SimulationResult first=run_simulation(config);
+    SimulationResult second=run_simulation(config);
+    REQUIRE(first.games.size()==20);
+    for(unsigned int index=0; index<20; ++index)
+    {
+        REQUIRE(first.games[index].seed==game_seed(5, index));
+        REQUIRE(first.games[index].score==second.games[index].score);
+        REQUIRE(first.games[index].pieces==second.games[index].pieces);
+        REQUIRE(first.games[index].is_over==true);
+    }
+
+    config.threads=4;
+    SimulationResult parallel=run_simulation(config);
+    for(unsigned int index=0; index<20; ++index)
+    {
+        REQUIRE(parallel.games[index].seed==first.games[index].seed);
+        REQUIRE(parallel.games[index].score==first.games[index].score);
+        REQUIRE(parallel.games[index].ticks==first.games[index].ticks);
+    }
+
+    RandomPolicy policy;
+    GameResult alone=play_game(config, game_seed(5, 3), policy);
+    REQUIRE(alone.score==first.games[3].score);
+    REQUIRE(alone.ticks==first.games[3].ticks);
+
+    std::ostringstream report;
+    print_report(report, first);
+    REQUIRE(report.str().find("games/s")!=std::string::npos);
+}
+
+TEST_CASE("run_simulation, tick budget")
+{
+    SimulationConfig config;
+    config.games=3;
+    config.max_ticks=50;
+    config.policy="idle";
+    SimulationResult result=run_simulation(config);
+    for(const GameResult& game : result.games)
+    {
+        REQUIRE(game.ticks==50);
+        REQUIRE(game.is_over==false);
+    }
+
+    config.policy="unknown";
+    REQUIRE(run_simulation(config).games.empty());
+}
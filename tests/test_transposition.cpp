@@ -0,0 +1,74 @@
+/**
+ * \file test_transposition.cpp
+ * \brief A series of Catch2 tests to ensure the good functionning
+ *  of the transposition table.
+ * \author Alexandre Bleuler - Bonaventure Dohemeto
+ * \version 2.0
+ * \date 18/10/2026
+ */
+
+
+#include "catch2/catch_test_macros.hpp"
+#include "parallel.h"
+#include "transposition.h"
+#include <atomic>
+#include <limits>
+
+
+TEST_CASE("TranspositionTable, store and probe")
+{
+    TranspositionTable table{1000};
+    REQUIRE(table.size()==1024);
+
+    double score=1;
+    // An empty table finds no key, 0 included.
+    REQUIRE(!table.probe(0, score));
+    REQUIRE(!table.probe(5, score));
+    REQUIRE(score==1);
+
+    table.store(5, -2.5);
+    REQUIRE(table.probe(5, score));
+    REQUIRE(score==-2.5);
+    table.store(0, -std::numeric_limits<double>::infinity());
+    REQUIRE(table.probe(0, score));
+    REQUIRE(score==-std::numeric_limits<double>::infinity());
+
+    // A key sharing the slot replaces the previous one.
+    table.store(5+1024, 3);
+    REQUIRE(!table.probe(5, score));
+    REQUIRE(table.probe(5+1024, score));
+    REQUIRE(score==3);
+
+    table.clear();
+    REQUIRE(!table.probe(5+1024, score));
+    REQUIRE(!table.probe(0, score));
+}
+
+TEST_CASE("TranspositionTable::key")
+{
+    Grid grid{20,10};
+    std::uint64_t key=TranspositionTable::key(grid.hash(), PieceType::I, PieceType::O);
+    REQUIRE(key==TranspositionTable::key(grid.hash(), PieceType::I, PieceType::O));
+    REQUIRE(key!=TranspositionTable::key(grid.hash(), PieceType::O, PieceType::I));
+    REQUIRE(key!=TranspositionTable::key(grid.hash(), PieceType::I, PieceType::T));
+    grid.put_piece(PieceType::I, 10);
+    REQUIRE(key!=TranspositionTable::key(grid.hash(), PieceType::I, PieceType::O));
+}
+
+TEST_CASE("TranspositionTable, concurrent stores")
+{
+    // Many threads write the same slots : a probe returns either a miss or the score
+    // stored with the key, never the score of another key.
+    TranspositionTable table{64};
+    std::atomic<bool> is_consistent{true};
+    parallel_for(200000, 4, [&](unsigned int worker, std::size_t index)
+    {
+        (void)worker;
+        std::uint64_t key=TranspositionTable::key(index%1000, PieceType::I, PieceType::O);
+        table.store(key, static_cast<double>(index%1000));
+        double score;
+        std::uint64_t other=TranspositionTable::key((index*7)%1000, PieceType::I, PieceType::O);
+        if(table.probe(other, score) && score!=static_cast<double>((index*7)%1000)) is_consistent=false;
+    });
+    REQUIRE(is_consistent);
+}
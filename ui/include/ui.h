@@ -10,12 +10,249 @@
 #ifndef UI_INCLUDE
 #define UI_INCLUDE
 
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <vector>
+
 #include <SFML/Graphics.hpp>
 #include <SFML/Window.hpp>
 #include <SFML/Audio/Music.hpp>
 #include <SFML/Audio/Sound.hpp>  
 #include <SFML/Audio/SoundBuffer.hpp>  
 
+#include "core_class.h"
+#include "game.h"
+#include "ai.h"
+
+/**
+ * \class BoardMesh
+ * \brief The cells of a grid drawn with a single draw call : every cell is a quad (two
+ * triangles) of one persistent sf::VertexArray. Only the quads of the cells marked as
+ * dirty by the grid (see Grid::dirty_rows) are rewritten, so an idle piece costs nothing.
+ */
+
+class BoardMesh : public sf::Drawable
+{
+    public :
+
+        /**
+         * \brief Brings the quads up to date with the dirty cells of a grid, which are then
+         * to be cleared by the caller. The quads are all rewritten the first time, or when the
+         * size or the position of the grid changes.
+         * \param grid The grid to draw.
+         * \param cell_row The row of the window cell of the top left cell of the grid.
+         * \param cell_column The column of the window cell of the top left cell of the grid.
+         * \return
+         */
+
+        void update(const Grid& grid, unsigned int cell_row, unsigned int cell_column);
+
+        /**
+         * \brief Forces every quad to be rewritten by the next update.
+         * \param
+         * \return
+         */
+
+        void invalidate() {_is_built = false;}
+
+    private :
+        sf::VertexArray _vertices{sf::PrimitiveType::Triangles}; /**< Six vertices for each cell, row after row. */
+        bool _is_built = false; /**< A boolean indicating if every quad has been written. */
+        unsigned int _nrow = 0; /**< The number of rows of the grid. */
+        unsigned int _ncol = 0; /**< The number of columns of the grid. */
+        unsigned int _cell_row=0; /**< The row of the window cell of the top left cell of the grid. */
+        unsigned int _cell_column=0; /**< The column of the window cell of the top left cell of the grid. */
+
+        /**
+         * \brief Rewrites the quad of a cell.
+         * \param row The row index of the cell in the grid.
+         * \param column The column index of the cell in the grid.
+         * \param color The color of the cell.
+         * \return
+         */
+
+        void write_cell(unsigned int row, unsigned int column, Color color);
+
+        void draw(sf::RenderTarget& target, sf::RenderStates states) const override;
+};
+
+/**
+ * \class PiecePreview
+ * \brief The quads of the seven piece shapes, in their spawn rotation, built once and
+ * drawn where and at the scale wanted : the upcoming pieces are shown without any grid.
+ */
+
+class PiecePreview
+{
+    public :
+
+        /**
+         * \brief Constructor of the class PiecePreview. The shapes are laid out in a box of
+         * 2 x 4 cells of UI::pixel_cell_size pixels, as Grid::put_piece would set them.
+         */
+
+        PiecePreview();
+
+        /**
+         * \brief Draws the shape of a piece.
+         * \param target The target on which the shape is drawn.
+         * \param type The type of the piece.
+         * \param position The position in pixels of the top left corner of the 2 x 4 box.
+         * \param scale The scale of the shape, 1 for cells of the size of the grid's ones.
+         * \return
+         */
+
+        void draw(sf::RenderTarget& target, PieceType type, sf::Vector2f position, float scale=1.f) const;
+
+    private :
+        sf::VertexArray _shapes[7]; /**< The six vertices of the four blocks of each shape, indexed by PieceType. */
+};
+
+/**
+ * \class Hud
+ * \brief The texts drawn around and over the grid : score, next piece label, controls,
+ * pause and game over screens. The sf::Text objects are kept from one frame to the next,
+ * their string being set and their position computed again only when the value they show
+ * changes, or when the size of the window does.
+ */
+
+class Hud
+{
+    public :
+
+        /**
+         * \brief Constructor of the class Hud.
+         * \param font The font of the texts, which must outlive the Hud.
+         */
+
+        Hud(const sf::Font& font);
+
+        /**
+         * \brief Draws the score and the best score, to the left of the grid.
+         * \param target The target on which the texts are drawn.
+         * \param score The score of the game.
+         * \param best_score The best score.
+         * \return
+         */
+
+        void draw_score(sf::RenderTarget& target, unsigned int score, int best_score);
+
+        /**
+         * \brief Draws the label of the next piece, to the right of the grid.
+         * \param target The target on which the label is drawn.
+         * \return
+         */
+
+        void draw_next_label(sf::RenderTarget& target);
+
+        /**
+         * \brief Draws the list of the controls, to the right of the grid.
+         * \param target The target on which the controls are drawn.
+         * \return
+         */
+
+        void draw_controls(sf::RenderTarget& target);
+
+        /**
+         * \brief Draws the pause screen over the game.
+         * \param target The target on which the pause screen is drawn.
+         * \return
+         */
+
+        void draw_pause_screen(sf::RenderTarget& target);
+
+        /**
+         * \brief Draws the game over screen.
+         * \param target The target on which the game over screen is drawn.
+         * \param score The final score of the game.
+         * \param best_score The best score.
+         * \return
+         */
+
+        void draw_game_over_screen(sf::RenderTarget& target, int score, int best_score);
+
+    private :
+        sf::Vector2u _size; /**< The size of the target the texts are laid out for. */
+
+        sf::Text _score_label; /**< The "Score :" label. */
+        sf::Text _score; /**< The score of the game. */
+        sf::Text _best_score; /**< The best score. */
+        long long _shown_score = -1; /**< The score shown by _score, -1 if it has to be set. */
+        long long _shown_best_score = -1; /**< The best score shown by _best_score, -1 if it has to be set. */
+
+        sf::Text _next_label; /**< The "Next piece :" label. */
+        sf::Text _controls_title; /**< The "Controls :" title. */
+        std::vector<sf::Text> _controls; /**< The lines of the list of the controls. */
+
+        sf::RectangleShape _pause_overlay; /**< The darkening of the game while paused. */
+        sf::Text _pause_title; /**< The "PAUSE" title. */
+        sf::Text _pause_instruction; /**< The keys available while paused. */
+
+        sf::RectangleShape _game_over_box; /**< The panel of the game over screen. */
+        sf::Text _game_over_title; /**< The "GAME OVER!" title. */
+        sf::Text _game_over_score; /**< The final score. */
+        sf::Text _game_over_best_score; /**< The best score. */
+        sf::Text _game_over_instruction; /**< The keys available after a game over. */
+        long long _shown_game_over_score = -1; /**< The score shown by _game_over_score, -1 if it has to be set. */
+        long long _shown_game_over_best_score = -1; /**< The best score shown by _game_over_best_score, -1 if it has to be set. */
+
+        /**
+         * \brief Lays the texts out for a target, if its size differs from the last one.
+         * The texts showing a value are then set again by the next draw.
+         * \param target The target on which the texts will be drawn.
+         * \return
+         */
+
+        void layout(const sf::RenderTarget& target);
+
+        /**
+         * \brief Centers a text horizontally in the window.
+         * \param text The text to center.
+         * \param top The vertical position of the text, in pixels.
+         * \return
+         */
+
+        void center_text(sf::Text& text, float top) const;
+};
+
+/**
+ * \class ScreenCache
+ * \brief A screen rendered once into an sf::RenderTexture and then copied on the window,
+ * for the screens which only change on a key press (menu, controls, best score). The
+ * screen is rendered again only when the value it shows, summed up in a key, changes.
+ */
+
+class ScreenCache
+{
+    public :
+
+        /**
+         * \brief Draws the screen on a window, rendering it first if the key or the size of
+         * the window differs from the cached ones. If the texture can't be created, the
+         * screen is rendered directly on the window.
+         * \param window The window on which the screen is drawn.
+         * \param key A value identifying the content of the screen.
+         * \param render The function drawing the screen on a target.
+         * \return
+         */
+
+        void draw(sf::RenderWindow& window, std::uint64_t key, const std::function<void(sf::RenderTarget&)>& render);
+
+        /**
+         * \brief Forces the screen to be rendered again by the next draw.
+         * \param
+         * \return
+         */
+
+        void invalidate() {_is_valid = false;}
+
+    private :
+        sf::RenderTexture _texture; /**< The rendered screen. */
+        std::uint64_t _key = 0; /**< The key of the rendered screen. */
+        bool _is_valid = false; /**< A boolean indicating if the texture holds the screen of _key. */
+};
+
 /**
  * \namespace UI
  * \brief A namespace to store variables linked to the UI of the game.
@@ -35,6 +272,12 @@ namespace UI
     extern unsigned int right_side_width_in_cell; /**< The width in cells of the part of the window to the right of the grid. */
 
     extern sf::RectangleShape cell; /**< An SFML rectangle to display Tetris' blocks. */
+    extern BoardMesh board_mesh; /**< The quads of the cells of the game's grid. */
+    extern PiecePreview piece_preview; /**< The shapes of the upcoming pieces. */
+    extern Hud hud; /**< The texts drawn around and over the game's grid. */
+    extern ScreenCache menu_screen; /**< The rendered main menu. */
+    extern ScreenCache controls_screen; /**< The rendered controls screen. */
+    extern ScreenCache best_score_screen; /**< The rendered best score screen. */
 
     constexpr sf::Color grey{110, 110, 110}; /**< Color grey for SFML. */
     constexpr sf::Color spawn_grey{70, 70, 70}; /**< Other color grey for SFML. */
@@ -42,10 +285,23 @@ namespace UI
     constexpr sf::Color pink{243 , 130, 185}; /**< Color pink for SFML. */
     constexpr sf::Color purple{224, 32, 255}; /**< Color purple for SFML. */
 
+    constexpr unsigned int preview_length = 3; /**< The number of upcoming pieces shown to the right of the grid. */
+
     extern sf::Font font; /**< A font for displaying texts with SFML (https://fontstruct.com/fontstructions/show/2350408). */
     extern unsigned int font_size; /**< The size of the font in pixels. */
+
+    extern std::string replay_path; /**< The file in which the replay of the last game over is saved. */
 };
 
+/**
+ * \brief A function to get the SFML color of a cell.
+ * \param color The color of the cell.
+ * \param row The row index of the cell in the grid, an empty cell of the 4 spawn rows being darker.
+ * \return The SFML color of the cell.
+ */
+
+sf::Color cell_color(Color color, unsigned int row);
+
 /**
  * \brief A function to draw the cells of a Tetris' grid on screen.
  * \param grid The grid from which the cell come.
@@ -58,16 +314,16 @@ namespace UI
  */
 
 
-void draw_cell(Grid& grid, sf::RenderWindow& window, unsigned int cell_row, unsigned int cell_column, unsigned int row, unsigned int column);
+void draw_cell(const Grid& grid, sf::RenderWindow& window, unsigned int cell_row, unsigned int cell_column, unsigned int row, unsigned int column);
 
 /**
- * \brief A function to draw the Tetris' grid on screen.
+ * \brief A function to draw the Tetris' grid on screen, in a single draw call (see BoardMesh).
  * \param grid The grid to draw.
  * \param window The window on which the grid will be drawn.
  * \return 
  */
 
-void draw_grid(Grid& grid, sf::RenderWindow& window);
+void draw_grid(const Grid& grid, sf::RenderWindow& window);
 
 /**
  * \brief A function to center a text on a line of cells on sides of the Tetris' grid.
@@ -87,17 +343,18 @@ void grid_sides_center_text(Move move, sf::Text& text, unsigned int cell_row);
  * \return 
  */
 
-void draw_score(Grid& next_piece_grid, sf::RenderWindow& window);
+void draw_score(const Grid& grid, sf::RenderWindow& window);
 
 /**
- * \brief A function to show the piece that the player will get the next turn.
- * \param window The window on which the next piece will be displayed.
- * \param newt_type The type of the next piece.
+ * \brief A function to show the pieces that the player will get the next turns : the next
+ * one at the size of the grid's cells, the following ones at half size below it.
+ * \param window The window on which the pieces will be displayed.
+ * \param next_types The types of the upcoming pieces, the next one first (see Game::preview).
+ * \param count The number of upcoming pieces to show.
  * \return 
  */
 
-
-void draw_next_piece(sf::RenderWindow& window, PieceType& next_type);
+void draw_next_pieces(sf::RenderWindow& window, const PieceType* next_types, std::size_t count);
 
 /**
  * @brief Draws the game over screen
@@ -134,31 +391,45 @@ enum class MenuChoice {
 
 /**
  * @brief Draws the main menu screen
- * @param window The render window
+ * @param window The target on which the menu is drawn
  * @param selectedChoice The currently selected menu option
  * @param bestScore The best score to display
  * \return
  */
-void draw_menu_screen(sf::RenderWindow& window, MenuChoice selectedChoice, int bestScore);
+void draw_menu_screen(sf::RenderTarget& window, MenuChoice selectedChoice, int bestScore);
 /**
- * @brief Displays the main menu and handles menu navigation
- * @param currentBestScore The best score to display
- * @return The menu choice selected by the player
- * \return
+ * @brief Displays the main menu from its cached rendering
+ * @details The menu is rendered again only when the selection or the best score changes.
+ * @param window The render window
+ * @param selectedChoice The currently selected menu option
+ * @param bestScore The best score to display
  */
-MenuChoice showMenu(int currentBestScore);
+void displayMenu(sf::RenderWindow& window, MenuChoice selectedChoice, int bestScore);
+
 /**
- * @brief Displays the controls screen
- * @param window The render window
+ * @brief Draws the controls screen
+ * @param window The target on which the screen is drawn
  */
-void draw_controls_screen(sf::RenderWindow& window);
+void draw_controls_screen(sf::RenderTarget& window);
 
 /**
- * @brief Displays the best score screen
- * @param window The render window
+ * @brief Draws the best score screen
+ * @param window The target on which the screen is drawn
  * @param bestScore The best score to display
  */
-void draw_best_score_screen(sf::RenderWindow& window, int bestScore);
+void draw_best_score_screen(sf::RenderTarget& window, int bestScore);
+
+/**
+ * @brief Displays a cached screen until ESC, ENTER or SPACE is pressed
+ * @details The window sleeps until an event comes instead of redrawing continuously.
+ * @param window The render window
+ * @param screen The cache of the screen
+ * @param key The value identifying the content of the screen
+ * @param render The function drawing the screen on a target
+ * @return False if the window was closed
+ */
+bool showScreen(sf::RenderWindow& window, ScreenCache& screen, std::uint64_t key,
+                const std::function<void(sf::RenderTarget&)>& render);
 
 /**
  * @brief Handles the menu navigation
@@ -181,31 +452,25 @@ bool executeMenuAction(MenuChoice selectedChoice, bool& inMenu,
 
 /**
  * @brief Initializes the game state
- * @details Sets up grid, current and next piece, and game parameters.
- * @param grid Reference to the game grid
- * @param current Reference to the current piece
- * @param next Reference to the next piece
- * @param gameOver Reference to the game over flag
- * @param timeDecreaseRate Reference to speed increase rate
- * @param scoreThreshold Reference to score threshold for level up
+ * @details Restarts the game engine with a seed taken from the current time.
+ * @param game Reference to the game engine
  */
-void initializeGame(Grid& grid, Piece& current, PieceType& next, bool& gameOver, 
-                    double& timeDecreaseRate, double& scoreThreshold);
+void initializeGame(Game& game);
 
 /**
  * @brief Restarts the game
  * @details Resets the game to its initial state and restarts the music.
  */
-void restartGame(Grid& grid, Piece& current, PieceType& next, bool& gameOver, 
-                 bool& isPaused, sf::Clock& clock, double& timeDecreaseRate, 
-                 double& scoreThreshold, sf::Music& music);
+void restartGame(Game& game, bool& isPaused, sf::Clock& clock, sf::Music& music);
 
 /**
  * @brief Handles player input during gameplay
- * @details Processes movement, rotation, drop, and menu navigation keys.
+ * @details Forwards movement and rotation keys to the game engine and plays their sounds.
+ * The A key switches the automatic player on and off.
+ * @param isAutoplay Reference to the flag telling if the automatic player drives the game
  */
-void handleGameInput(Grid& grid, Piece& current, bool& isPaused, bool& isQuit,
-                     bool& goToMenu, sf::Sound& moveLeftSound, sf::Sound& moveRightSound,
+void handleGameInput(Game& game, bool& isPaused, bool& isQuit,
+                     bool& goToMenu, bool& isAutoplay, sf::Sound& moveLeftSound, sf::Sound& moveRightSound,
                      sf::Sound& clockwiseSound, sf::Sound& anticlockwiseSound,
                      sf::Sound& dropSound);
 
@@ -213,34 +478,33 @@ void handleGameInput(Grid& grid, Piece& current, bool& isPaused, bool& isQuit,
  * @brief Handles input when game is paused
  * @details Allows resuming, quitting, or returning to menu while paused.
  */
-void handlePauseInput(bool& isPaused, bool& isQuit, bool& goToMenu, Grid& grid,
-                      Piece& current, PieceType& next, double& timeDecreaseRate,
-                      double& scoreThreshold, sf::Clock& clock, sf::Music& music,
-                      sf::Sound& pauseSound);
+void handlePauseInput(bool& isPaused, bool& isQuit, bool& goToMenu, Game& game,
+                      sf::Clock& clock, sf::Music& music, sf::Sound& pauseSound);
 
 /**
  * @brief Handles input when game is over
  * @details Allows restarting or quitting the game after Game Over.
  */
-void handleGameOverInput(Grid& grid, Piece& current, PieceType& next, 
-                         bool& gameOver, bool& isPaused, sf::Clock& clock, 
-                         double& timeDecreaseRate, double& scoreThreshold, 
+void handleGameOverInput(Game& game, bool& isPaused, sf::Clock& clock,
                          sf::Music& music, bool& isQuit, bool& goToMenu);
 
 /**
- * @brief Updates game logic: movement, collision, scoring
- * @details Updates piece position, checks for lines, updates score and speed.
+ * @brief Advances the game engine in real time
+ * @details Converts the time elapsed since the last call into engine ticks.
+ * @param lag Reference to the elapsed time not yet consumed by a tick
  */
-void updateGame(Grid& grid, Piece& current, PieceType& next, bool& gameOver,
-                sf::Clock& clock, double& timeDecreaseRate, double& scoreThreshold,
-                sf::Sound& dropSound, sf::Sound& successSound, sf::Sound& levelUpSound,
-                sf::Sound& gameOverSound, sf::Music& music, int& bestScore);
+void updateGame(Game& game, sf::Clock& clock, sf::Time& lag);
 
 /**
- * @brief Renders the current game state
- * @details Draws the grid, current and next pieces, and pause overlay if needed.
+ * @brief Handles the events emitted by the game engine
+ * @details Plays the sounds and music changes matching the events, whether they come
+ * from a tick or from an input such as a hard drop, and updates the best score.
+ * When the game is over, its replay is saved in UI::replay_path.
+ * @param bestScore Reference to the best score
  */
-void drawGame(sf::RenderWindow& window, Grid& grid, PieceType& next, bool isPaused);
+void handleGameEvents(Game& game, sf::Sound& dropSound, sf::Sound& successSound, sf::Sound& levelUpSound,
+                      sf::Sound& gameOverSound, sf::Music& music, int& bestScore);
+
 /**
  * @brief Loads the best score from file
  * @param filename The name of the score file
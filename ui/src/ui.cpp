@@ -13,6 +13,8 @@
 #include <SFML/Audio/Music.hpp>
 #include <SFML/Window.hpp>
 #include "core_class.h"
+#include "game.h"
+#include "replay.h"
 #include "ui.h"
 #include <fstream> 
 
@@ -35,62 +37,117 @@ namespace UI
 
     // Visual elements
     sf::RectangleShape cell(sf::Vector2f(pixel_cell_size - 1.f, pixel_cell_size - 1.f));
+    BoardMesh board_mesh;
+    PiecePreview piece_preview;
     sf::Font font("../ui/Tetris_font.ttf");
     unsigned int font_size = pixel_cell_size * left_side_width_in_cell / 10;
+    Hud hud(font);
+    ScreenCache menu_screen;
+    ScreenCache controls_screen;
+    ScreenCache best_score_screen;
+
+    // Replay of the last game, to be played back with tetris_sim --replay
+    std::string replay_path = "last_game.replay";
 }
 
-// Draw single cell with appropriate color
-void draw_cell(Grid& grid, sf::RenderWindow& window, unsigned int cell_row, unsigned int cell_column, unsigned int row, unsigned int column)
+// SFML color of a cell
+sf::Color cell_color(Color color, unsigned int row)
 {
-    Color cell_color = grid(row, column).color();
-    UI::cell.setPosition(sf::Vector2f(
-        (cell_column + column) * UI::pixel_cell_size,
-        (cell_row + row) * UI::pixel_cell_size
-    ));
-    
-    switch(cell_color)
+    switch(color)
     {
         case Color::blue: 
-            UI::cell.setFillColor(sf::Color::Blue);
-            break;
+            return sf::Color::Blue;
         case Color::yellow:  
-            UI::cell.setFillColor(sf::Color::Yellow);
-            break;
+            return sf::Color::Yellow;
         case Color::purple: 
-            UI::cell.setFillColor(UI::purple);
-            break;
+            return UI::purple;
         case Color::orange: 
-            UI::cell.setFillColor(UI::orange);
-            break;
+            return UI::orange;
         case Color::pink: 
-            UI::cell.setFillColor(UI::pink);
-            break;
+            return UI::pink;
         case Color::red: 
-            UI::cell.setFillColor(sf::Color::Red);
-            break;
+            return sf::Color::Red;
         case Color::green: 
-            UI::cell.setFillColor(sf::Color::Green);
-            break;
+            return sf::Color::Green;
         case Color::none:
-            if(row > 3) UI::cell.setFillColor(UI::grey);
-            else UI::cell.setFillColor(UI::spawn_grey);
-            break;
+        default:
+            return row > 3 ? UI::grey : UI::spawn_grey;
     }
+}
+
+// Draw single cell with appropriate color
+void draw_cell(const Grid& grid, sf::RenderWindow& window, unsigned int cell_row, unsigned int cell_column, unsigned int row, unsigned int column)
+{
+    UI::cell.setPosition(sf::Vector2f(
+        (cell_column + column) * UI::pixel_cell_size,
+        (cell_row + row) * UI::pixel_cell_size
+    ));
+    UI::cell.setFillColor(cell_color(grid(row, column).color(), row));
     window.draw(UI::cell);
 }
 
-// Draw entire game grid
-void draw_grid(Grid& grid, sf::RenderWindow& window)
-{   
-    for (unsigned int r = 0; r < grid.column_size(); ++r)
+/////////////////////////////
+////// BoardMesh class //////
+/////////////////////////////
+
+void BoardMesh::update(const Grid& grid, unsigned int cell_row, unsigned int cell_column)
+{
+    if (!_is_built || grid.column_size() != _nrow || grid.row_size() != _ncol
+        || cell_row != _cell_row || cell_column != _cell_column)
     {
-        for (unsigned int c = 0; c < grid.row_size(); ++c)
-        {   
-            draw_cell(grid, window, 1, UI::left_side_width_in_cell, r, c);
+        _nrow = grid.column_size();
+        _ncol = grid.row_size();
+        _cell_row = cell_row;
+        _cell_column = cell_column;
+        _vertices.resize(6 * static_cast<std::size_t>(_nrow) * _ncol);
+        for (unsigned int r = 0; r < _nrow; ++r)
+        {
+            for (unsigned int c = 0; c < _ncol; ++c) write_cell(r, c, grid(r, c).color());
         }
+        _is_built = true;
+        return;
+    }
+
+    for (unsigned int r : grid.dirty_rows())
+    {
+        std::uint64_t cells = grid.dirty_cells(r);
+        for (unsigned int c = 0; cells != 0; ++c, cells >>= 1)
+        {
+            if (cells & 1u) write_cell(r, c, grid(r, c).color());
+        }
+    }
+}
+
+void BoardMesh::write_cell(unsigned int row, unsigned int column, Color color)
+{
+    // The quad leaves a one pixel gap with its neighbours, as UI::cell does.
+    float left = static_cast<float>((_cell_column + column) * UI::pixel_cell_size);
+    float top = static_cast<float>((_cell_row + row) * UI::pixel_cell_size);
+    float right = left + UI::pixel_cell_size - 1.f;
+    float bottom = top + UI::pixel_cell_size - 1.f;
+    const sf::Vector2f corners[6] = {{left, top}, {right, top}, {left, bottom},
+                                     {left, bottom}, {right, top}, {right, bottom}};
+    sf::Color fill = cell_color(color, row);
+    std::size_t first = 6 * (static_cast<std::size_t>(row) * _ncol + column);
+    for (std::size_t i = 0; i < 6; ++i)
+    {
+        _vertices[first + i].position = corners[i];
+        _vertices[first + i].color = fill;
     }
 }
 
+void BoardMesh::draw(sf::RenderTarget& target, sf::RenderStates states) const
+{
+    target.draw(_vertices, states);
+}
+
+// Draw entire game grid
+void draw_grid(const Grid& grid, sf::RenderWindow& window)
+{   
+    UI::board_mesh.update(grid, 1, UI::left_side_width_in_cell);
+    window.draw(UI::board_mesh);
+}
+
 // Position text on left or right side of grid
 void grid_sides_center_text(Move move, sf::Text& text, unsigned int cell_row)
 {
@@ -112,205 +169,268 @@ void grid_sides_center_text(Move move, sf::Text& text, unsigned int cell_row)
     text.setPosition(sf::Vector2f(margin, cell_row * UI::pixel_cell_size));
 }
 
-// Display score information
-void draw_score(Grid& grid, sf::RenderWindow& window)
-{
-    sf::Text text(UI::font);
-    text.setCharacterSize(UI::font_size);
-    
-    // Score label
-    text.setString("Score :");
-    text.setFillColor(sf::Color::White);
-    grid_sides_center_text(Move::left, text, 2);
-    window.draw(text);
-    
-    // Current score
-    text.setString(std::to_string(grid.score()));
-    grid_sides_center_text(Move::left, text, 4);
-    window.draw(text);
-    
-    // Best score
-    extern int bestScore;
-    text.setString("Best : " + std::to_string(bestScore));
-    grid_sides_center_text(Move::left, text, 6);
-    window.draw(text);
-}
+////////////////////////////////
+////// PiecePreview class //////
+////////////////////////////////
 
-// Display next piece preview
-void draw_next_piece(sf::RenderWindow& window, PieceType& next_type)
-{   
-    sf::Text text(UI::font);
-    text.setCharacterSize(UI::font_size);
-    text.setString("Next piece :");
-    text.setFillColor(sf::Color::White);
-    grid_sides_center_text(Move::right, text, 2);
-    window.draw(text);
-    
-    // Create preview grid
-    Grid next_piece_grid(2, 4);
-    next_piece_grid.put_piece(next_type, 0);
-    
-    // Draw next piece
-    unsigned cell_column = UI::left_side_width_in_cell + UI::column_number;
-    cell_column += (UI::right_side_width_in_cell - 4) / 2;
-    
-    for (unsigned int r = 0; r < next_piece_grid.column_size(); ++r)
+PiecePreview::PiecePreview()
+{
+    for (unsigned int type = 0; type < 7; ++type)
     {
-        for (unsigned int c = 0; c < next_piece_grid.row_size(); ++c)
-        {   
-            if(next_piece_grid(r, c).is_full()) 
-                draw_cell(next_piece_grid, window, 5, cell_column, r, c);
+        sf::VertexArray& shape = _shapes[type];
+        shape.setPrimitiveType(sf::PrimitiveType::Triangles);
+        shape.resize(24);
+        sf::Color fill = cell_color(Piece{static_cast<PieceType>(type)}.color(), 0);
+        for (unsigned int i = 0; i < 4; ++i)
+        {
+            // The pivot is set on the first row and the third column of the box, as
+            // Grid::put_piece does in a grid of 4 columns.
+            const BlockOffset& offset = piece_shapes[type][0][i];
+            float left = static_cast<float>((2 + offset.column) * static_cast<int>(UI::pixel_cell_size));
+            float top = static_cast<float>(offset.row * static_cast<int>(UI::pixel_cell_size));
+            float right = left + UI::pixel_cell_size - 1.f;
+            float bottom = top + UI::pixel_cell_size - 1.f;
+            const sf::Vector2f corners[6] = {{left, top}, {right, top}, {left, bottom},
+                                             {left, bottom}, {right, top}, {right, bottom}};
+            for (std::size_t j = 0; j < 6; ++j)
+            {
+                shape[6 * i + j].position = corners[j];
+                shape[6 * i + j].color = fill;
+            }
         }
     }
 }
 
-// Game over screen display
-void draw_game_over_screen(sf::RenderWindow& window, int score, int bestScore)
+void PiecePreview::draw(sf::RenderTarget& target, PieceType type, sf::Vector2f position, float scale) const
 {
-    // Text elements for game over screen
-    sf::Text gameOverText(UI::font);
-    gameOverText.setCharacterSize(UI::font_size * 1);
-    gameOverText.setFillColor(sf::Color::Red);
-    gameOverText.setString("GAME OVER!");
-    
-    sf::Text scoreText(UI::font);
-    scoreText.setCharacterSize(UI::font_size * 0.75f);
-    scoreText.setFillColor(sf::Color::White);
-    scoreText.setString("Score: " + std::to_string(score));
-    
-    sf::Text bestScoreText(UI::font);
-    bestScoreText.setCharacterSize(UI::font_size * 0.75f);
-    bestScoreText.setFillColor(sf::Color::Yellow);
-    bestScoreText.setString("Best: " + std::to_string(bestScore));
-    
-    sf::Text instructionText(UI::font);
-    instructionText.setCharacterSize(UI::font_size * 0.5);
-    instructionText.setFillColor(sf::Color::Yellow);
-    instructionText.setString("Press R to restart or Esc to return to menu !");
-    
-    // Background panel
-    float maxWidth = 0.75f * UI::width_in_cell * UI::pixel_cell_size;
-    float totalHeight = 0.40f * UI::height_in_cell * UI::pixel_cell_size;
-    
-    sf::RectangleShape background(sf::Vector2f(maxWidth, totalHeight));
-    background.setFillColor(sf::Color(30, 30, 30, 230));
-    background.setOutlineThickness(3.f);
-    background.setOutlineColor(sf::Color::White);
-    
-    // Position calculation
-    sf::Vector2f windowSize(window.getSize().x, window.getSize().y);
-    sf::Vector2f backgroundPos(
-        windowSize.x / 2.f - maxWidth / 2.f,
-        windowSize.y / 2.f - totalHeight / 2.f
-    );
-    background.setPosition(backgroundPos);
-    
-    double box_upper_row = backgroundPos.y;
-    double box_height = background.getGlobalBounds().size.y;
-    
-    // Position and draw all elements
-    unsigned int text_width = gameOverText.getGlobalBounds().size.x;
-    gameOverText.setPosition(sf::Vector2f(
-        (UI::width_in_cell * UI::pixel_cell_size - text_width) / 2,
-        box_upper_row + 1 * box_height / 10
-    ));
-    
-    text_width = scoreText.getGlobalBounds().size.x;
-    scoreText.setPosition(sf::Vector2f(
-        (UI::width_in_cell * UI::pixel_cell_size - text_width) / 2,
-        box_upper_row + 3 * box_height / 10
-    ));
-    
-    text_width = bestScoreText.getGlobalBounds().size.x;
-    bestScoreText.setPosition(sf::Vector2f(
-        (UI::width_in_cell * UI::pixel_cell_size - text_width) / 2,
-        box_upper_row + 5 * box_height / 10
-    ));
-    
-    text_width = instructionText.getGlobalBounds().size.x;
-    instructionText.setPosition(sf::Vector2f(
-        (UI::width_in_cell * UI::pixel_cell_size - text_width) / 2,
-        box_upper_row + 7 * box_height / 10
-    ));
-    
-    window.draw(background);
-    window.draw(gameOverText);
-    window.draw(scoreText);
-    window.draw(bestScoreText);
-    window.draw(instructionText);
+    sf::Transform transform;
+    transform.translate(position).scale(sf::Vector2f(scale, scale));
+    target.draw(_shapes[static_cast<int>(type)], sf::RenderStates(transform));
 }
 
-// Display control instructions
-void draw_controls(sf::RenderWindow& window)
+///////////////////////
+////// Hud class //////
+///////////////////////
+
+Hud::Hud(const sf::Font& font)
+    : _score_label(font, "Score :", UI::font_size), _score(font, "", UI::font_size),
+      _best_score(font, "", UI::font_size), _next_label(font, "Next piece :", UI::font_size),
+      _controls_title(font, "Controls :", UI::font_size),
+      _pause_title(font, "PAUSE", static_cast<unsigned int>(UI::font_size * 1.5)),
+      _pause_instruction(font, "Press |P: resume | R: start a new game |  Esc: return to menu ", UI::font_size),
+      _game_over_title(font, "GAME OVER!", UI::font_size),
+      _game_over_score(font, "", static_cast<unsigned int>(UI::font_size * 0.75f)),
+      _game_over_best_score(font, "", static_cast<unsigned int>(UI::font_size * 0.75f)),
+      _game_over_instruction(font, "Press R to restart or Esc to return to menu !", static_cast<unsigned int>(UI::font_size * 0.5))
 {
-    sf::Text text(UI::font);
-    text.setCharacterSize(UI::font_size);
-    text.setFillColor(sf::Color::White);
-    
-    std::vector<std::string> controls = {
+    const char* controls[] = {
         " left arrow : Moving left",
         " right arrow : Moving right",
         " down arrow : Moving down ",
         " up arrow : Anti-clockwise rotation",
         " Space : Clockwise rotation",
+        " Enter : Hard drop",
+        " A : AI autoplay",
         "P : Resume"
     };
-    
-    // Controls title
-    text.setString("Controls :");
-    grid_sides_center_text(Move::right, text, 10);
-    window.draw(text);
-    
-    // List controls
-    text.setCharacterSize(UI::font_size * 0.7f);
-    for(size_t i = 0; i < controls.size(); ++i)
+    for (const char* control : controls)
+    {
+        _controls.emplace_back(font, control, static_cast<unsigned int>(UI::font_size * 0.7f));
+    }
+
+    _pause_overlay.setFillColor(sf::Color(0, 0, 0, 150));
+    _pause_title.setFillColor(sf::Color::Yellow);
+    _game_over_box.setFillColor(sf::Color(30, 30, 30, 230));
+    _game_over_box.setOutlineThickness(3.f);
+    _game_over_box.setOutlineColor(sf::Color::White);
+    _game_over_title.setFillColor(sf::Color::Red);
+    _game_over_best_score.setFillColor(sf::Color::Yellow);
+    _game_over_instruction.setFillColor(sf::Color::Yellow);
+}
+
+void Hud::layout(const sf::RenderTarget& target)
+{
+    if (target.getSize() == _size) return;
+    _size = target.getSize();
+
+    grid_sides_center_text(Move::left, _score_label, 2);
+    grid_sides_center_text(Move::right, _next_label, 2);
+    grid_sides_center_text(Move::right, _controls_title, 10);
+    for (std::size_t i = 0; i < _controls.size(); ++i)
+    {
+        grid_sides_center_text(Move::right, _controls[i], 13 + i);
+    }
+
+    // Pause screen
+    _pause_overlay.setSize(sf::Vector2f(_size.x, _size.y));
+    unsigned int text_height = _pause_title.getGlobalBounds().size.y;
+    center_text(_pause_title, ((UI::height_in_cell - 6) * UI::pixel_cell_size - text_height) / 2);
+    text_height = _pause_instruction.getGlobalBounds().size.y;
+    center_text(_pause_instruction, ((UI::height_in_cell + 2) * UI::pixel_cell_size - text_height) / 2);
+
+    // Game over panel, centered in the window
+    float maxWidth = 0.75f * UI::width_in_cell * UI::pixel_cell_size;
+    float totalHeight = 0.40f * UI::height_in_cell * UI::pixel_cell_size;
+    _game_over_box.setSize(sf::Vector2f(maxWidth, totalHeight));
+    _game_over_box.setPosition(sf::Vector2f(
+        _size.x / 2.f - maxWidth / 2.f,
+        _size.y / 2.f - totalHeight / 2.f
+    ));
+    float box_upper_row = _game_over_box.getPosition().y;
+    float box_height = _game_over_box.getGlobalBounds().size.y;
+    center_text(_game_over_title, box_upper_row + 1 * box_height / 10);
+    center_text(_game_over_instruction, box_upper_row + 7 * box_height / 10);
+
+    // The texts showing a value are positioned when set
+    _shown_score = -1;
+    _shown_best_score = -1;
+    _shown_game_over_score = -1;
+    _shown_game_over_best_score = -1;
+}
+
+void Hud::center_text(sf::Text& text, float top) const
+{
+    unsigned int text_width = text.getGlobalBounds().size.x;
+    text.setPosition(sf::Vector2f((UI::width_in_cell * UI::pixel_cell_size - text_width) / 2, top));
+}
+
+void Hud::draw_score(sf::RenderTarget& target, unsigned int score, int best_score)
+{
+    layout(target);
+    if (_shown_score != score)
+    {
+        _shown_score = score;
+        _score.setString(std::to_string(score));
+        grid_sides_center_text(Move::left, _score, 4);
+    }
+    if (_shown_best_score != best_score)
+    {
+        _shown_best_score = best_score;
+        _best_score.setString("Best : " + std::to_string(best_score));
+        grid_sides_center_text(Move::left, _best_score, 6);
+    }
+    target.draw(_score_label);
+    target.draw(_score);
+    target.draw(_best_score);
+}
+
+void Hud::draw_next_label(sf::RenderTarget& target)
+{
+    layout(target);
+    target.draw(_next_label);
+}
+
+void Hud::draw_controls(sf::RenderTarget& target)
+{
+    layout(target);
+    target.draw(_controls_title);
+    for (const sf::Text& control : _controls) target.draw(control);
+}
+
+void Hud::draw_pause_screen(sf::RenderTarget& target)
+{
+    layout(target);
+    target.draw(_pause_overlay);
+    target.draw(_pause_title);
+    target.draw(_pause_instruction);
+}
+
+void Hud::draw_game_over_screen(sf::RenderTarget& target, int score, int best_score)
+{
+    layout(target);
+    float box_upper_row = _game_over_box.getPosition().y;
+    float box_height = _game_over_box.getGlobalBounds().size.y;
+    if (_shown_game_over_score != score)
+    {
+        _shown_game_over_score = score;
+        _game_over_score.setString("Score: " + std::to_string(score));
+        center_text(_game_over_score, box_upper_row + 3 * box_height / 10);
+    }
+    if (_shown_game_over_best_score != best_score)
     {
-        text.setString(controls[i]);
-        grid_sides_center_text(Move::right, text, 13 + i);
-        window.draw(text);
+        _shown_game_over_best_score = best_score;
+        _game_over_best_score.setString("Best: " + std::to_string(best_score));
+        center_text(_game_over_best_score, box_upper_row + 5 * box_height / 10);
     }
+    target.draw(_game_over_box);
+    target.draw(_game_over_title);
+    target.draw(_game_over_score);
+    target.draw(_game_over_best_score);
+    target.draw(_game_over_instruction);
+}
+
+///////////////////////////////
+////// ScreenCache class //////
+///////////////////////////////
+
+void ScreenCache::draw(sf::RenderWindow& window, std::uint64_t key, const std::function<void(sf::RenderTarget&)>& render)
+{
+    if (!_is_valid || key != _key || _texture.getSize() != window.getSize())
+    {
+        if (_texture.getSize() != window.getSize() && !_texture.resize(window.getSize()))
+        {
+            _is_valid = false;
+            render(window);
+            return;
+        }
+        _texture.clear(sf::Color::Black);
+        render(_texture);
+        _texture.display();
+        _key = key;
+        _is_valid = true;
+    }
+    window.draw(sf::Sprite(_texture.getTexture()));
+}
+
+// Display score information
+void draw_score(const Grid& grid, sf::RenderWindow& window)
+{
+    extern int bestScore;
+    UI::hud.draw_score(window, grid.score(), bestScore);
+}
+
+// Display next pieces preview
+void draw_next_pieces(sf::RenderWindow& window, const PieceType* next_types, std::size_t count)
+{   
+    UI::hud.draw_next_label(window);
+    if (count == 0) return;
+    
+    // Next piece, centered in a box of 2 x 4 cells
+    float side_left = static_cast<float>((UI::left_side_width_in_cell + UI::column_number) * UI::pixel_cell_size);
+    float left = side_left + (UI::right_side_width_in_cell - 4) / 2 * UI::pixel_cell_size;
+    UI::piece_preview.draw(window, next_types[0], sf::Vector2f(left, 5.f * UI::pixel_cell_size));
+    
+    // Following pieces at half size, side by side with one cell between them
+    if (count == 1) return;
+    float width = (3 * (count - 1) - 1) * static_cast<float>(UI::pixel_cell_size);
+    left = side_left + (UI::right_side_width_in_cell * UI::pixel_cell_size - width) / 2;
+    for (std::size_t i = 1; i < count; ++i)
+    {
+        UI::piece_preview.draw(window, next_types[i], sf::Vector2f(left, 8.f * UI::pixel_cell_size), 0.5f);
+        left += 3.f * UI::pixel_cell_size;
+    }
+}
+
+// Game over screen display
+void draw_game_over_screen(sf::RenderWindow& window, int score, int bestScore)
+{
+    UI::hud.draw_game_over_screen(window, score, bestScore);
+}
+
+// Display control instructions
+void draw_controls(sf::RenderWindow& window)
+{
+    UI::hud.draw_controls(window);
 }
 
 // Pause screen overlay
 void draw_pause_screen(sf::RenderWindow& window)
 {
-    // Semi-transparent overlay
-    sf::RectangleShape overlay(sf::Vector2f(window.getSize().x, window.getSize().y));
-    overlay.setFillColor(sf::Color(0, 0, 0, 150));
-    
-    // Pause text
-    sf::Text pause_text(UI::font);
-    pause_text.setCharacterSize(UI::font_size * 1.5);
-    pause_text.setFillColor(sf::Color::Yellow);
-    pause_text.setString("PAUSE");
-    
-    unsigned int text_width = pause_text.getGlobalBounds().size.x;
-    unsigned int text_height = pause_text.getGlobalBounds().size.y;
-    pause_text.setPosition(sf::Vector2f(
-        (UI::width_in_cell * UI::pixel_cell_size - text_width) / 2,  
-        ((UI::height_in_cell - 6) * UI::pixel_cell_size - text_height) / 2    
-    ));
-    
-    // Instructions
-    sf::Text instruction_text(UI::font);
-    instruction_text.setCharacterSize(UI::font_size);
-    instruction_text.setFillColor(sf::Color::White);
-    instruction_text.setString("Press |P: resume | R: start a new game |  Esc: return to menu ");
-   
-    text_width = instruction_text.getGlobalBounds().size.x;
-    text_height = instruction_text.getGlobalBounds().size.y;
-    instruction_text.setPosition(sf::Vector2f(
-        (UI::width_in_cell * UI::pixel_cell_size - text_width) / 2,  
-        ((UI::height_in_cell + 2) * UI::pixel_cell_size - text_height) / 2    
-    ));
-    
-    window.draw(overlay);
-    window.draw(pause_text);
-    window.draw(instruction_text);
+    UI::hud.draw_pause_screen(window);
 }
 
 // Main menu display
-void draw_menu_screen(sf::RenderWindow& window, MenuChoice selectedChoice, int bestScore)
+void draw_menu_screen(sf::RenderTarget& window, MenuChoice selectedChoice, int bestScore)
 {
     // Menu text elements
     sf::Text titleText(UI::font);
@@ -413,99 +533,37 @@ void draw_menu_screen(sf::RenderWindow& window, MenuChoice selectedChoice, int b
 // Global best score
 extern int bestScore; 
 
-// Main menu logic
-MenuChoice showMenu(int bestScore)
+// Draw the cached main menu
+void displayMenu(sf::RenderWindow& window, MenuChoice selectedChoice, int bestScore)
 {
-    bool in_menu = true;
-    MenuChoice menu_selection = MenuChoice::StartGame;
-
-    while (in_menu && UI::window.isOpen())
+    std::uint64_t key = (static_cast<std::uint64_t>(selectedChoice) << 32) | static_cast<std::uint32_t>(bestScore);
+    window.clear(sf::Color::Black);
+    UI::menu_screen.draw(window, key, [&](sf::RenderTarget& target)
     {
-        while (auto event = UI::window.pollEvent())
-        {
-            if (event->is<sf::Event::Closed>())
-                UI::window.close();
-
-            if (const auto* key = event->getIf<sf::Event::KeyPressed>())
-            {
-                // Menu navigation
-                if (key->scancode == sf::Keyboard::Scan::Up)
-                {
-                    if (menu_selection == MenuChoice::StartGame)
-                        menu_selection = MenuChoice::Quit;
-                    else if (menu_selection == MenuChoice::Controls)
-                        menu_selection = MenuChoice::StartGame;
-                    else if (menu_selection == MenuChoice::BestScore)
-                        menu_selection = MenuChoice::Controls;
-                    else if (menu_selection == MenuChoice::Quit)
-                        menu_selection = MenuChoice::BestScore;
-                }
-                else if (key->scancode == sf::Keyboard::Scan::Down)
-                {
-                    if (menu_selection == MenuChoice::StartGame)
-                        menu_selection = MenuChoice::Controls;
-                    else if (menu_selection == MenuChoice::Controls)
-                        menu_selection = MenuChoice::BestScore;
-                    else if (menu_selection == MenuChoice::BestScore)
-                        menu_selection = MenuChoice::Quit;
-                    else if (menu_selection == MenuChoice::Quit)
-                        menu_selection = MenuChoice::StartGame;
-                }
-                // Selection
-                else if (key->scancode == sf::Keyboard::Scan::Enter ||
-                        key->scancode == sf::Keyboard::Scan::Space)
-                {
-                    return menu_selection;
-                }
-                else if (key->scancode == sf::Keyboard::Scan::Escape)
-                {
-                    return MenuChoice::Quit;
-                }
-            }
-        }
-
-        // Draw menu
-        UI::window.clear(sf::Color::Black);
-        draw_menu_screen(UI::window, menu_selection, bestScore);
-        UI::window.display();
-    }
-
-    return MenuChoice::Quit;
+        draw_menu_screen(target, selectedChoice, bestScore);
+    });
+    window.display();
 }
 
 // Game initialization
-void initializeGame(Grid& grid, Piece& current, PieceType& next, bool& gameOver,
-                   double& timeDecreaseRate, double& scoreThreshold)
+void initializeGame(Game& game)
 {
-    srand(static_cast<unsigned int>(time(nullptr)));
-    grid = Grid(UI::row_number, UI::column_number);
-    current = grid.put_piece(createRandomPiece());
-    next = createRandomPiece();
-    gameOver = false;
-    timeDecreaseRate = 0;
-    scoreThreshold = 200;
+    game.reset(static_cast<std::uint64_t>(time(nullptr)));
 }
 
 // Restart game
-void restartGame(Grid& grid, Piece& current, PieceType& next, bool& gameOver,
-                bool& isPaused, sf::Clock& clock, double& timeDecreaseRate,
-                double& scoreThreshold, sf::Music& music)
+void restartGame(Game& game, bool& isPaused, sf::Clock& clock, sf::Music& music)
 {
-    grid = Grid(UI::row_number, UI::column_number);
-    current = grid.put_piece(createRandomPiece());
-    next = createRandomPiece();
-    gameOver = false;
+    game.reset(static_cast<std::uint64_t>(time(nullptr)));
     isPaused = false;
-    timeDecreaseRate = 0;
-    scoreThreshold = 200;
     clock.restart();
     music.stop();
     music.play();
 }
 
 // Handle in-game input
-void handleGameInput(Grid& grid, Piece& current, bool& isPaused, bool& isQuit,
-                    bool& goToMenu, sf::Sound& moveLeftSound, sf::Sound& moveRightSound,
+void handleGameInput(Game& game, bool& isPaused, bool& isQuit,
+                    bool& goToMenu, bool& isAutoplay, sf::Sound& moveLeftSound, sf::Sound& moveRightSound,
                     sf::Sound& clockwiseSound, sf::Sound& anticlockwiseSound,
                     sf::Sound& dropSound)
 {
@@ -523,41 +581,48 @@ void handleGameInput(Grid& grid, Piece& current, bool& isPaused, bool& isQuit,
             }
             else if (!isPaused)
             {
-                if (key->scancode == sf::Keyboard::Scan::Left)
+                if (key->scancode == sf::Keyboard::Scan::A)
                 {
-                    grid.move_piece(current, Move::left);
+                    isAutoplay = !isAutoplay;
+                }
+                else if (key->scancode == sf::Keyboard::Scan::Left)
+                {
+                    game.input(Move::left);
                     moveLeftSound.play();
                 }
                 else if (key->scancode == sf::Keyboard::Scan::Right)
                 {
-                    grid.move_piece(current, Move::right);
+                    game.input(Move::right);
                     moveRightSound.play();
                 }
                 else if (key->scancode == sf::Keyboard::Scan::Down)
                 {
-                    grid.move_piece(current, Move::down);
+                    game.input(Move::down);
                     dropSound.play();
                 }
                 else if (key->scancode == sf::Keyboard::Scan::Up)
                 {
-                    grid.move_piece(current, Move::clock_rotation);
+                    game.input(Move::clock_rotation);
                     clockwiseSound.play();
                 }
                 else if (key->scancode == sf::Keyboard::Scan::Space)
                 {
-                    grid.move_piece(current, Move::anticlock_rotation);
+                    game.input(Move::anticlock_rotation);
                     anticlockwiseSound.play();
                 }
+                else if (key->scancode == sf::Keyboard::Scan::Enter)
+                {
+                    // The landing sound is played by the piece_locked event.
+                    game.input(Move::hard_drop);
+                }
             }
         }
     }
 }
 
 // Handle pause menu input
-void handlePauseInput(bool& isPaused, bool& isQuit, bool& goToMenu, Grid& grid,
-                     Piece& current, PieceType& next, double& timeDecreaseRate,
-                     double& scoreThreshold, sf::Clock& clock, sf::Music& music,
-                     sf::Sound& pauseSound)
+void handlePauseInput(bool& isPaused, bool& isQuit, bool& goToMenu, Game& game,
+                     sf::Clock& clock, sf::Music& music, sf::Sound& pauseSound)
 {
     if (auto event = UI::window.pollEvent())
     {
@@ -573,17 +638,14 @@ void handlePauseInput(bool& isPaused, bool& isQuit, bool& goToMenu, Grid& grid,
             }
             else if (key->scancode == sf::Keyboard::Scan::R)
             {
-                restartGame(grid, current, next, isPaused, isPaused, clock,
-                           timeDecreaseRate, scoreThreshold, music);
+                restartGame(game, isPaused, clock, music);
             }
         }
     }
 }
 
 // Handle game over input
-void handleGameOverInput(Grid& grid, Piece& current, PieceType& next,
-                        bool& gameOver, bool& isPaused, sf::Clock& clock,
-                        double& timeDecreaseRate, double& scoreThreshold,
+void handleGameOverInput(Game& game, bool& isPaused, sf::Clock& clock,
                         sf::Music& music, bool& isQuit, bool& goToMenu)
 {
     if (auto event = UI::window.pollEvent())
@@ -592,8 +654,7 @@ void handleGameOverInput(Grid& grid, Piece& current, PieceType& next,
         {
             if (key->scancode == sf::Keyboard::Scan::R)
             {
-                restartGame(grid, current, next, gameOver, isPaused, clock,
-                           timeDecreaseRate, scoreThreshold, music);
+                restartGame(game, isPaused, clock, music);
                 goToMenu = false;
             }
             else if (key->scancode == sf::Keyboard::Scan::Escape)
@@ -605,63 +666,54 @@ void handleGameOverInput(Grid& grid, Piece& current, PieceType& next,
 }
 
 // Game update logic
-void updateGame(Grid& grid, Piece& current, PieceType& next, bool& gameOver,
-               sf::Clock& clock, double& timeDecreaseRate, double& scoreThreshold,
-               sf::Sound& dropSound, sf::Sound& successSound, sf::Sound& levelUpSound,
-               sf::Sound& gameOverSound, sf::Music& music, int& bestScore)
+void updateGame(Game& game, sf::Clock& clock, sf::Time& lag)
 {
-    if (clock.getElapsedTime().asSeconds() > (1 - timeDecreaseRate) * 0.6)
+    // The engine advances by fixed ticks : the elapsed time is accumulated and
+    // consumed tick by tick. It is capped so that a long stall doesn't make the
+    // piece jump several rows at once.
+    const sf::Time tickDuration = sf::seconds(1.f / game.ticks_per_second());
+    const sf::Time maxLag = sf::milliseconds(250);
+    lag += clock.restart();
+    if (lag > maxLag) lag = maxLag;
+    while (lag >= tickDuration && !game.is_over())
     {
-        bool hasMoved = grid.move_piece(current, Move::down);
-        if (!hasMoved)
-        {
-            dropSound.play();
-            gameOver = grid.update();
-            bestScore = std::max(bestScore, static_cast<int>(grid.score()));
-
-            if (gameOver)
-            {
-                gameOverSound.play();
-                music.stop();
-            }
-            else if (grid.score() > scoreThreshold)
-            {
-                scoreThreshold *= 2.25;
-                timeDecreaseRate += 0.05;
-                music.stop();
-                levelUpSound.play();
-                music.play();
-            }
-
-            if (!gameOver)
-            {
-                current = grid.put_piece(next);
-                next = createRandomPiece();
-            }
-        }
-        clock.restart();
+        game.tick();
+        lag -= tickDuration;
     }
 }
 
-// Draw game state
-void drawGame(sf::RenderWindow& window, Grid& grid, PieceType& next, bool isPaused)
+// Game events handling
+void handleGameEvents(Game& game, sf::Sound& dropSound, sf::Sound& successSound, sf::Sound& levelUpSound,
+                      sf::Sound& gameOverSound, sf::Music& music, int& bestScore)
 {
-    window.clear(sf::Color::Black);
-    draw_grid(grid, window);
-    draw_score(grid, window);
-    draw_next_piece(window, next);
-    draw_controls(window);
-    
-    if (isPaused)
+    for (GameEvent event : game.events())
     {
-        draw_pause_screen(window);
+        switch (event)
+        {
+            case GameEvent::piece_locked:
+                dropSound.play();
+                break;
+            case GameEvent::lines_cleared:
+                successSound.play();
+                break;
+            case GameEvent::level_up:
+                music.stop();
+                levelUpSound.play();
+                music.play();
+                break;
+            case GameEvent::game_over:
+                gameOverSound.play();
+                music.stop();
+                save_replay(UI::replay_path, make_replay(game));
+                break;
+        }
     }
-    
-    window.display();
+    game.clear_events();
+    bestScore = std::max(bestScore, static_cast<int>(game.score()));
 }
 
 // Controls screen
-void draw_controls_screen(sf::RenderWindow& window)
+void draw_controls_screen(sf::RenderTarget& window)
 {
     sf::RectangleShape overlay(sf::Vector2f(window.getSize().x, window.getSize().y));
     overlay.setFillColor(sf::Color(0, 0, 0, 220));
@@ -676,6 +728,8 @@ void draw_controls_screen(sf::RenderWindow& window)
         "Down Arrow : Move piece downward faster",
         "Up Arrow : Anti-clockwise rotation",
         "Space : Clockwise rotation",
+        "Enter : Drop piece to the bottom",
+        "A : Let the AI play (on/off)",
         "P : Pause/Resume game",
         "R : Restart game",
         "ESC : Quit game/Exit"
@@ -721,7 +775,7 @@ void draw_controls_screen(sf::RenderWindow& window)
 }
 
 // Best score screen
-void draw_best_score_screen(sf::RenderWindow& window, int bestScore)
+void draw_best_score_screen(sf::RenderTarget& window, int bestScore)
 {
     sf::RectangleShape overlay(sf::Vector2f(window.getSize().x, window.getSize().y));
     overlay.setFillColor(sf::Color(0, 0, 0, 220));
@@ -811,66 +865,14 @@ bool executeMenuAction(MenuChoice selectedChoice, bool& inMenu,
             return true;
             
         case MenuChoice::Controls:
-        {
-            bool inControls = true;
-            while (inControls && window.isOpen())
-            {
-                while (auto event = window.pollEvent())
-                {
-                    if (event->is<sf::Event::Closed>())
-                    {
-                        window.close();
-                        return false;
-                    }
-                    
-                    if (const auto* key = event->getIf<sf::Event::KeyPressed>())
-                    {
-                        if (key->scancode == sf::Keyboard::Scan::Escape ||
-                            key->scancode == sf::Keyboard::Scan::Enter ||
-                            key->scancode == sf::Keyboard::Scan::Space)
-                        {
-                            inControls = false;
-                        }
-                    }
-                }
-                
-                window.clear(sf::Color::Black);
-                draw_controls_screen(window);
-                window.display();
-            }
+            if (!showScreen(window, UI::controls_screen, 0, draw_controls_screen)) return false;
             break;
-        }
             
         case MenuChoice::BestScore:
-        {
-            bool inBestScore = true;
-            while (inBestScore && window.isOpen())
-            {
-                while (auto event = window.pollEvent())
-                {
-                    if (event->is<sf::Event::Closed>())
-                    {
-                        window.close();
-                        return false;
-                    }
-                    
-                    if (const auto* key = event->getIf<sf::Event::KeyPressed>())
-                    {
-                        if (key->scancode == sf::Keyboard::Scan::Escape ||
-                            key->scancode == sf::Keyboard::Scan::Enter ||
-                            key->scancode == sf::Keyboard::Scan::Space)
-                        {
-                            inBestScore = false;
-                        }
-                    }
-                }
-                
-                window.clear(sf::Color::Black);
-                draw_best_score_screen(window, bestScore);
-                window.display();
-            }
+            if (!showScreen(window, UI::best_score_screen, static_cast<std::uint32_t>(bestScore),
+                            [&](sf::RenderTarget& target) {draw_best_score_screen(target, bestScore);}))
+                return false;
             break;
-        }
             
         case MenuChoice::Quit:
             window.close();
@@ -882,6 +884,36 @@ bool executeMenuAction(MenuChoice selectedChoice, bool& inMenu,
     return false;
 }
 
+// Static screen left with ESC, ENTER or SPACE
+bool showScreen(sf::RenderWindow& window, ScreenCache& screen, std::uint64_t key,
+                const std::function<void(sf::RenderTarget&)>& render)
+{
+    while (window.isOpen())
+    {
+        window.clear(sf::Color::Black);
+        screen.draw(window, key, render);
+        window.display();
+
+        const std::optional<sf::Event> event = window.waitEvent();
+        if (!event) continue;
+        if (event->is<sf::Event::Closed>())
+        {
+            window.close();
+            return false;
+        }
+        if (const auto* key_pressed = event->getIf<sf::Event::KeyPressed>())
+        {
+            if (key_pressed->scancode == sf::Keyboard::Scan::Escape ||
+                key_pressed->scancode == sf::Keyboard::Scan::Enter ||
+                key_pressed->scancode == sf::Keyboard::Scan::Space)
+            {
+                return true;
+            }
+        }
+    }
+    return false;
+}
+
 // Load best score from file
 void loadBestScore(const std::string& filename, int& bestScore)
 {
@@ -925,27 +957,20 @@ bool loadSounds(sf::SoundBuffer soundBuffers[], std::vector<std::unique_ptr<sf::
 void runGame()
 {
     // Game state
-    Grid grid(UI::row_number, UI::column_number);
-    Piece current = grid.put_piece(createRandomPiece());
-    PieceType next = createRandomPiece();
-    bool isGameOver = false;
+    Game game(UI::row_number, UI::column_number, static_cast<std::uint64_t>(time(nullptr)));
+    game.set_recording(true);
+    game.set_dirty_tracking(true);
     bool isPaused = false;
     bool isQuit = false;
     bool goToMenu = false;
-    double timeDecreaseRate = 0;
-    double scoreThreshold = 200;
-    
-    // Initialize
-    srand(static_cast<unsigned int>(time(nullptr)));
-    grid = Grid(UI::row_number, UI::column_number);
-    current = grid.put_piece(createRandomPiece());
-    next = createRandomPiece();
-    isGameOver = false;
-    timeDecreaseRate = 0;
-    scoreThreshold = 200;
+
+    // Automatic player, searching on every core and allowed 5 ms to choose each placement
+    bool isAutoplay = false;
+    AiPolicy autoplayer(AiWeights{}, std::chrono::milliseconds(5), 0);
     
     // Timing
     sf::Clock clock;
+    sf::Time lag = sf::Time::Zero;
     UI::window.setFramerateLimit(60);
     
     // Load music
@@ -994,23 +1019,21 @@ void runGame()
     while (UI::window.isOpen() && !isQuit && !goToMenu)
     {
         // Input handling based on state
-        if (!isGameOver)
+        if (!game.is_over())
         {
             if (isPaused)
             {
-                handlePauseInput(isPaused, isQuit, goToMenu, grid, current, next,
-                                timeDecreaseRate, scoreThreshold, clock, music, *sounds[7]);
+                handlePauseInput(isPaused, isQuit, goToMenu, game, clock, music, *sounds[7]);
             }
             else
             {
-                handleGameInput(grid, current, isPaused, isQuit, goToMenu,
+                handleGameInput(game, isPaused, isQuit, goToMenu, isAutoplay,
                                *sounds[0], *sounds[1], *sounds[2], *sounds[3], *sounds[4]);
             }
         }
         else
         {
-            handleGameOverInput(grid, current, next, isGameOver, isPaused, clock,
-                               timeDecreaseRate, scoreThreshold, music, isQuit, goToMenu);
+            handleGameOverInput(game, isPaused, clock, music, isQuit, goToMenu);
             
             if (goToMenu)
             {
@@ -1020,21 +1043,38 @@ void runGame()
         }
         
         // Game update
-        if (!isPaused && !isGameOver)
+        if (!isPaused && !game.is_over())
+        {
+            if (isAutoplay)
+            {
+                Move move = autoplayer.choose(game);
+                if (move != Move::none) game.input(move);
+            }
+            updateGame(game, clock, lag);
+        }
+        else
+        {
+            clock.restart();
+        }
+
+        // Events of the ticks and of the inputs : a hard drop may lock the piece and
+        // end the game before any tick.
+        if (!game.events().empty())
         {
-            updateGame(grid, current, next, isGameOver, clock, timeDecreaseRate,
-                      scoreThreshold, *sounds[4], *sounds[5], *sounds[6], *sounds[7],
-                      music, bestScore);
+            handleGameEvents(game, *sounds[4], *sounds[5], *sounds[6], *sounds[7], music, bestScore);
         }
         
         // Rendering
         UI::window.clear(sf::Color::Black);
         
-        if (!isGameOver)
+        if (!game.is_over())
         {
-            draw_grid(grid, UI::window);
-            draw_score(grid, UI::window);
-            draw_next_piece(UI::window, next);
+            draw_grid(game.grid(), UI::window);
+            game.clear_dirty();
+            draw_score(game.grid(), UI::window);
+            PieceType nextPieces[UI::preview_length];
+            game.preview(nextPieces, UI::preview_length);
+            draw_next_pieces(UI::window, nextPieces, UI::preview_length);
             draw_controls(UI::window);
             
             if (isPaused)
@@ -1044,7 +1084,7 @@ void runGame()
         }
         else
         {
-            draw_game_over_screen(UI::window, static_cast<int>(grid.score()), bestScore);
+            draw_game_over_screen(UI::window, static_cast<int>(game.score()), bestScore);
         }
         
         UI::window.display();
@@ -1069,134 +1109,35 @@ bool showMainMenu(int bestScore)
     
     while (inMenu && UI::window.isOpen())
     {
-        while (auto event = UI::window.pollEvent())
+        // The menu only changes on a key press : the window sleeps until the next event.
+        displayMenu(UI::window, menuSelection, bestScore);
+        const std::optional<sf::Event> event = UI::window.waitEvent();
+        if (!event) continue;
+
+        if (event->is<sf::Event::Closed>())
+        {
+            UI::window.close();
+            return false;
+        }
+        
+        // Navigation
+        if (handleMenuNavigation(menuSelection, *event)) continue;
+
+        if (const auto* key = event->getIf<sf::Event::KeyPressed>())
         {
-            if (event->is<sf::Event::Closed>())
+            // Selection
+            if (key->scancode == sf::Keyboard::Scan::Enter ||
+                key->scancode == sf::Keyboard::Scan::Space)
             {
-                UI::window.close();
-                return false;
+                if (executeMenuAction(menuSelection, inMenu, UI::window, bestScore)) return true;
             }
-            
-            if (const auto* key = event->getIf<sf::Event::KeyPressed>())
+            else if (key->scancode == sf::Keyboard::Scan::Escape)
             {
-                // Navigation
-                if (key->scancode == sf::Keyboard::Scan::Up)
-                {
-                    if (menuSelection == MenuChoice::StartGame)
-                        menuSelection = MenuChoice::Quit;
-                    else if (menuSelection == MenuChoice::Controls)
-                        menuSelection = MenuChoice::StartGame;
-                    else if (menuSelection == MenuChoice::BestScore)
-                        menuSelection = MenuChoice::Controls;
-                    else if (menuSelection == MenuChoice::Quit)
-                        menuSelection = MenuChoice::BestScore;
-                }
-                else if (key->scancode == sf::Keyboard::Scan::Down)
-                {
-                    if (menuSelection == MenuChoice::StartGame)
-                        menuSelection = MenuChoice::Controls;
-                    else if (menuSelection == MenuChoice::Controls)
-                        menuSelection = MenuChoice::BestScore;
-                    else if (menuSelection == MenuChoice::BestScore)
-                        menuSelection = MenuChoice::Quit;
-                    else if (menuSelection == MenuChoice::Quit)
-                        menuSelection = MenuChoice::StartGame;
-                }
-                // Selection
-                else if (key->scancode == sf::Keyboard::Scan::Enter ||
-                        key->scancode == sf::Keyboard::Scan::Space)
-                {
-                    switch (menuSelection)
-                    {
-                        case MenuChoice::StartGame:
-                            inMenu = false;
-                            return true;
-                            
-                        case MenuChoice::Controls:
-                        {
-                            bool inControls = true;
-                            while (inControls && UI::window.isOpen())
-                            {
-                                // Handle controls screen
-                                while (auto ev = UI::window.pollEvent())
-                                {
-                                    if (ev->is<sf::Event::Closed>())
-                                    {
-                                        UI::window.close();
-                                        return false;
-                                    }
-                                    
-                                    if (const auto* keyCtrl = ev->getIf<sf::Event::KeyPressed>())
-                                    {
-                                        if (keyCtrl->scancode == sf::Keyboard::Scan::Escape ||
-                                            keyCtrl->scancode == sf::Keyboard::Scan::Enter ||
-                                            keyCtrl->scancode == sf::Keyboard::Scan::Space)
-                                        {
-                                            inControls = false;
-                                        }
-                                    }
-                                }
-                                
-                                UI::window.clear(sf::Color::Black);
-                                draw_controls_screen(UI::window);
-                                UI::window.display();
-                            }
-                            break;
-                        }
-                            
-                        case MenuChoice::BestScore:
-                        {
-                            bool inBestScore = true;
-                            while (inBestScore && UI::window.isOpen())
-                            {
-                                // Handle best score screen
-                                while (auto ev = UI::window.pollEvent())
-                                {
-                                    if (ev->is<sf::Event::Closed>())
-                                    {
-                                        UI::window.close();
-                                        return false;
-                                    }
-                                    
-                                    if (const auto* keyScore = ev->getIf<sf::Event::KeyPressed>())
-                                    {
-                                        if (keyScore->scancode == sf::Keyboard::Scan::Escape ||
-                                            keyScore->scancode == sf::Keyboard::Scan::Enter ||
-                                            keyScore->scancode == sf::Keyboard::Scan::Space)
-                                        {
-                                            inBestScore = false;
-                                        }
-                                    }
-                                }
-                                
-                                UI::window.clear(sf::Color::Black);
-                                draw_best_score_screen(UI::window, bestScore);
-                                UI::window.display();
-                            }
-                            break;
-                        }
-                            
-                        case MenuChoice::Quit:
-                            UI::window.close();
-                            return false;
-                            
-                        default:
-                            break;
-                    }
-                }
-                else if (key->scancode == sf::Keyboard::Scan::Escape)
-                {
-                    UI::window.close();
-                    return false;
-                }
+                UI::window.close();
+                return false;
             }
         }
-        
-        // Draw menu
-        UI::window.clear(sf::Color::Black);
-        draw_menu_screen(UI::window, menuSelection, bestScore);
-        UI::window.display();
     }
     
     return false;
-}
\ No newline at end of file
+}